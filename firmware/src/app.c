@@ -60,6 +60,11 @@
 #include "timers.h"
 #include "stdio.h"
 #include "app_ble_handler.h"
+#include "app_ble_bulk.h"
+#include "app_ble_evt_pool.h"
+#include "app_ble_adv.h"
+#include "app_ble_peri_adv.h"
+#include "osal_pool.h"
 #include "motor_control.h"
 
 // *****************************************************************************
@@ -126,6 +131,8 @@ void APP_Initialize ( void )
 
 
     appData.appQueue = xQueueCreate( 64, sizeof(APP_Msg_T) );
+    OSAL_POOL_Init();
+    APP_BLE_EvtPool_Init();
     /* TODO: Initialize your application's state machine and other
      * parameters.
      */
@@ -133,26 +140,113 @@ void APP_Initialize ( void )
 
 
 
-/* This function is called after TCC period event */
-void TCC_PeriodEventHandler(uint32_t status, uintptr_t context)
-{
-    /* duty cycle values */
-    static uint32_t duty0 = 200U;
+static uint16_t telemetrySequence = 0;
 
-    TCC1_PWM24bitDutySet(TCC1_CHANNEL1, duty0);    
+/* Stamps and sends a telemetry record, the status fields are filled by the caller */
+void APP_SendTelemetry(motorTlmRecord_t *p_rec, motorTlmType_t type)
+{
+    uint8_t buffer[MOTOR_TLM_RECORD_LEN];
+
+    p_rec->version = MOTOR_TLM_VERSION;
+    p_rec->type = (uint8_t)type;
+    p_rec->sequence = telemetrySequence++;
+    p_rec->timestamp = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    // a newer status sample supersedes a queued one, events are kept in order
+    sendNotificationMessage((const char *)buffer, Motor_Telemetry_Encode(p_rec, buffer),
+                            (type == MOTOR_TLM_SAMPLE) ? APP_BLE_NTF_COALESCE : APP_BLE_NTF_DROP_OLDEST);
 }
 
+/* Motor and button events arrive in interrupts, report them from the task */
+static void APP_PostTelemetryEvent(motorTlmType_t type, int32_t position)
+{
+    APP_Msg_T appMsg;
 
-
-extern void sendNotificationMessage(const char* buffer, uint32_t len);
+    appMsg.msgId = APP_MSG_MOTOR_EVT;
+    appMsg.msgData[0] = (uint8_t)type;
+    memcpy(&appMsg.msgData[1], &position, sizeof(position));
+    OSAL_QUEUE_SendISR(&appData.appQueue, &appMsg);
+}
 
 void Button_InterruptHandler(uintptr_t context)
 {
     (void)context;
-    Motor_Stop();
-    char buffer[128];
-    snprintf(buffer, 128, "Obstruction detected. Stopping motor!");
-    sendNotificationMessage(buffer, strlen(buffer));
+    Motor_Latency_Button();
+    Motor_EmergencyStop();
+    APP_PostTelemetryEvent(MOTOR_TLM_EVENT_OBSTRUCTION, Motor_GetPosition());
+}
+
+/* Sends the waiting stream samples, as many per packet as the link allows. An
+ * open bulk channel takes the stream as L2CAP SDUs, otherwise it goes out as
+ * notifications sized to the smallest ATT MTU of the subscribed links. */
+static void APP_TelemetryStreamDrain(void)
+{
+    static uint8_t buffer[BLE_L2CAP_MAX_SDU_SIZE];
+    motorTlmStream_t *p_stream = Motor_GetTelemetryStream();
+    bool bulk = APP_BLE_Bulk_IsOpen();
+    bool sent;
+    uint16_t maxLen;
+    uint16_t len;
+    uint8_t count;
+
+    // samples pushed from here on wake the task again
+    Motor_Telemetry_StreamAck(p_stream);
+    if (bulk)
+    {
+        maxLen = APP_BLE_Bulk_MaxSdu();
+    }
+    else
+    {
+        // zero while nobody is subscribed
+        maxLen = APP_GetNotificationMaxLen();
+    }
+    if (maxLen < (MOTOR_TLM_STREAM_HEADER_LEN + Motor_Telemetry_SampleLen(p_stream->fields)))
+    {
+        // nobody listens or not even one sample fits a packet
+        Motor_Telemetry_StreamFlush(p_stream);
+        return;
+    }
+    while ((len = Motor_Telemetry_StreamPack(p_stream, buffer, maxLen, telemetrySequence,
+                                             MOTOR_CTRL_LOOP_HZ, &count)) != 0U)
+    {
+        if (bulk)
+        {
+            sent = APP_BLE_Bulk_Send(buffer, len);
+        }
+        else
+        {
+            sent = sendNotificationMessage((const char *)buffer, len, APP_BLE_NTF_KEEP);
+        }
+        if (!sent)
+        {
+            // out of credits or link backlog is full, the samples stay in the stream for the next wake-up
+            break;
+        }
+        telemetrySequence++;
+        Motor_Telemetry_StreamRelease(p_stream, count);
+    }
+}
+
+void APP_MotorEventHandler(motorEvent_t event, int32_t position, uintptr_t context)
+{
+    APP_Msg_T appMsg;
+    motorTlmType_t type = MOTOR_TLM_EVENT_FAULT;
+
+    (void)context;
+    if (event == MOTOR_EVENT_TELEMETRY)
+    {
+        appMsg.msgId = APP_MSG_TELEMETRY;
+        OSAL_QUEUE_SendISR(&appData.appQueue, &appMsg);
+        return;
+    }
+    if (event == MOTOR_EVENT_MOVE_DONE)
+    {
+        type = MOTOR_TLM_EVENT_MOVE_DONE;
+    }
+    else if (event == MOTOR_EVENT_MOVE_STOPPED)
+    {
+        type = MOTOR_TLM_EVENT_MOVE_STOPPED;
+    }
+    APP_PostTelemetryEvent(type, position);
 }
 
 TimerHandle_t qeiTimer = 0;
@@ -161,19 +255,11 @@ void vTimerCallback( TimerHandle_t pxTimer )
 {
     (void)pxTimer;
     
-    char buffer[128];
-    static int32_t lastVelocity = 10000;
-    int32_t velocity = QEI_VelocityGet();
-    // the motor has 120 pulses per revolution
-    // QEI produces 4 pulses per revolution (so /480))
-    velocity= (velocity*60)/480;
-    if (velocity != lastVelocity)
-    {
-        snprintf(buffer, 128, "Velocity %ld rpm", velocity);
-        sendNotificationMessage(buffer, strlen(buffer));
-        lastVelocity = velocity;
-    }
-    ////SYS_CONSOLE_PRINT("Velocity %d rpm\r\n", velocity/4);
+    APP_Msg_T appMsg;
+
+    // the connection list, the notification queues and the advertising data belong to the application task
+    appMsg.msgId = APP_MSG_TICK;
+    OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0);
 }
 
 /******************************************************************************
@@ -216,10 +302,15 @@ void APP_Tasks ( void )
             bool appInitialized = true;
             //appData.appQueue = xQueueCreate( 10, sizeof(APP_Msg_T) );
             APP_BleStackInit();
+#if APP_BLE_PERI_ADV_EXTENDED
+            // Periodic train or the scan for other motors' trains, both scan for the door remote
+            APP_BLE_PeriAdv_Start();
+#else
             // Scanning Enabled
             BLE_GAP_SetScanningEnable(true, BLE_GAP_SCAN_FD_DISABLE, BLE_GAP_SCAN_MODE_OBSERVER, 0);
             // Output the status string to UART
             SYS_CONSOLE_MESSAGE("Scanning \r\n");
+#endif
 
 
             APP_StartAdvertising();
@@ -228,13 +319,13 @@ void APP_Tasks ( void )
             xTimerStart(qeiTimer,0);
             QEI_Start();
 
-            Motor_Start();
-            
-            /* Register callback function for period event */
-            //TCC1_PWMCallbackRegister(TCC_PeriodEventHandler, (uintptr_t)NULL);
-             /* Read the period */
-            //period = TCC1_PWM24bitPeriodGet();
-    
+            // control loop runs from the TCC1 period interrupt
+            Motor_Initialize();
+            Motor_EventCallbackRegister(APP_MotorEventHandler, 0);
+            if (!Motor_Start())
+            {
+                SYS_CONSOLE_MESSAGE("Motor start dropped\r\n");
+            }
 
 
             if (appInitialized)
@@ -252,8 +343,49 @@ void APP_Tasks ( void )
 
                 if(p_appMsg->msgId==APP_MSG_BLE_STACK_EVT)
                 {
+                    APP_BLE_EvtBlock_T *p_block = p_appMsg->p_block;
+
+                    // set by APP_BleStackCb for the writes it traces
+                    if (p_block->traceStamp != 0U)
+                    {
+                        Motor_Latency_Received(p_block->traceStamp);
+                    }
                     // Pass BLE Stack Event Message to User Application for handling
-                    APP_BleStackEvtHandler((STACK_Event_T *)p_appMsg->msgData);
+                    APP_BleStackEvtHandler(&p_block->stackEvt);
+                    APP_BLE_EvtPool_Free(p_block);
+                }
+                else if(p_appMsg->msgId==APP_MSG_MOTOR_EVT)
+                {
+                    motorTlmRecord_t record;
+
+                    // the position is the one captured when the event happened
+                    Motor_GetStatus(&record);
+                    memcpy(&record.position, &p_appMsg->msgData[1], sizeof(record.position));
+                    APP_SendTelemetry(&record, (motorTlmType_t)p_appMsg->msgData[0]);
+                }
+                else if(p_appMsg->msgId==APP_MSG_TELEMETRY)
+                {
+                    APP_TelemetryStreamDrain();
+                }
+                else if(p_appMsg->msgId==APP_MSG_TICK)
+                {
+                    static motorTlmRecord_t last;
+                    motorTlmRecord_t record;
+
+                    APP_ConnPolicyTick((Motor_GetState() != MOTOR_OFF) || (Motor_GetTelemetryStream()->decimation != 0U));
+                    // sampled by the control loop, QEI velocity counter is cleared on read
+                    memset(&record, 0, sizeof(record));
+                    Motor_GetStatus(&record);
+                    // only while something changes, the header is compared while still zero
+                    if (memcmp(&record, &last, sizeof(record)) != 0)
+                    {
+                        last = record;
+                        APP_SendTelemetry(&record, MOTOR_TLM_SAMPLE);
+                    }
+                    APP_BLE_Adv_UpdateStatus(&record);
+#if APP_BLE_PERI_ADV_EXTENDED
+                    APP_BLE_PeriAdv_Tick(&record);
+#endif
                 }
             }
             break;
@@ -103,13 +103,21 @@ typedef enum APP_MsgId_T
     APP_MSG_ZB_STACK_EVT,
     APP_MSG_ZB_STACK_CB,
     APP_MSG_UART_CB,  
+    APP_MSG_MOTOR_EVT,
+    APP_MSG_TELEMETRY,
+    APP_MSG_TICK,
     APP_MSG_STACK_END
 } APP_MsgId_T;
 
+/* Small payloads travel in msgData, BLE stack events in a pool block the
+   receiver returns, see app_ble_evt_pool.h */
+#define APP_MSG_DATA_LEN        (8U)
+
 typedef struct APP_Msg_T
 {
     uint8_t msgId;
-    uint8_t msgData[256];
+    uint8_t msgData[APP_MSG_DATA_LEN];
+    struct APP_BLE_EvtBlock_T *p_block;
 } APP_Msg_T;
 
 // *****************************************************************************
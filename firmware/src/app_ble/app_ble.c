@@ -46,9 +46,14 @@
 #include "osal/osal_freertos_extend.h"
 #include "app_ble.h"
 #include "app_ble_handler.h"
+#include "app_ble_bulk.h"
 #include "system/console/sys_console.h"
 #include "ble_cms/ble_ctrl_svc.h"
 #include "svc_client.h"
+#include "motor_latency.h"
+#include "app_ble_evt_pool.h"
+#include "app_ble_adv.h"
+#include "app_ble_peri_adv.h"
 
 
 
@@ -63,6 +68,13 @@
 // Section: Macros
 // *****************************************************************************
 // *****************************************************************************
+/* Largest TLV command frame, one ATT write at the largest MTU. CTRL
+   characteristic 0 is set up in the MCC Customized Service, see README.md */
+#define APP_CTRL_CHAR0_MAX_LEN          (BLE_ATT_MAX_MTU_LEN - ATT_WRITE_HEADER_SIZE)
+
+/* Largest telemetry notification, the stream packs samples up to the MTU
+   of the link and never past the size of CTRL characteristic 1 */
+#define APP_CTRL_CHAR1_MAX_LEN          (BLE_ATT_MAX_MTU_LEN - ATT_HANDLE_VALUE_HEADER_SIZE)
 
 
 // *****************************************************************************
@@ -85,6 +97,37 @@ BLE_DD_Config_T         g_ddConfig;
 // *****************************************************************************
 // *****************************************************************************
 
+/* The CTRL service is generated by MCC, a regeneration with the stock
+   Customized Service settings cuts characteristic 0 back to a fixed 4
+   byte value and the stack refuses every TLV frame, and characteristic 1
+   back to 128 bytes, which silently shortens the packed telemetry
+   stream. A value length right after the service is added is its full
+   size, the first byte of a declaration holds the properties */
+static void APP_CtrlSvcCheck(void)
+{
+    static uint8_t value[BLE_ATT_MAX_MTU_LEN];
+    uint16_t len = sizeof(value);
+
+    if ((GATTS_GetHandleValue(CTRL_HDL_CHAR_0, value, &len) != MBA_RES_SUCCESS) || (len == 0U) ||
+        ((value[0] & ATT_PROP_WRITE_CMD) == 0U))
+    {
+        // setpoint streaming writes without response
+        SYS_CONSOLE_MESSAGE("CTRL characteristic 0 needs Write Without Response, check the Customized Service in MCC\r\n");
+    }
+    len = sizeof(value);
+    if ((GATTS_GetHandleValue(CTRL_HDL_CHARVAL_0, value, &len) != MBA_RES_SUCCESS) || (len < APP_CTRL_CHAR0_MAX_LEN))
+    {
+        SYS_CONSOLE_PRINT("CTRL characteristic 0 holds %d bytes instead of %d, check the Customized Service in MCC\r\n",
+            len, APP_CTRL_CHAR0_MAX_LEN);
+    }
+    len = sizeof(value);
+    if ((GATTS_GetHandleValue(CTRL_HDL_CHARVAL_1, value, &len) != MBA_RES_SUCCESS) || (len < APP_CTRL_CHAR1_MAX_LEN))
+    {
+        SYS_CONSOLE_PRINT("CTRL characteristic 1 holds %d bytes instead of %d, check the Customized Service in MCC\r\n",
+            len, APP_CTRL_CHAR1_MAX_LEN);
+    }
+}
+
 static void APP_DdEvtHandler(BLE_DD_Event_T *p_event)
 {
     //SYS_CONSOLE_PRINT("APP_DdEvtHandler %d\r\n", p_event->eventId);
@@ -92,46 +135,55 @@ static void APP_DdEvtHandler(BLE_DD_Event_T *p_event)
 
 }
 
+/* Runs in the stack task, the event and the CCCD list it points to are only
+ * valid during the call: both are copied into one pool block and the block
+ * is passed to the application task */
 static void APP_BleStackCb(STACK_Event_T *p_stack)
 {
-    STACK_Event_T stackEvent;
+    APP_BLE_EvtBlock_T *p_block;
     APP_Msg_T   appMsg;
-    APP_Msg_T   *p_appMsg;
+    uint32_t    receivedStamp = Motor_Latency_Stamp();
+    uint16_t    evtLen = (p_stack->evtLen + 3U) & ~3U;
+    uint16_t    cccdLen = 0;
+    GATT_Event_T *p_evtGatt = (GATT_Event_T *)p_stack->p_event;
 
-    (void)memcpy((uint8_t *)&stackEvent, (uint8_t *)p_stack, sizeof(STACK_Event_T));
-    stackEvent.p_event=OSAL_Malloc(p_stack->evtLen);
-    if(stackEvent.p_event==NULL)
+    if ((p_stack->groupId == STACK_GRP_GATT) && (p_evtGatt->eventId == GATTS_EVT_CLIENT_CCCDLIST_CHANGE))
+    {
+        cccdLen = (uint16_t)p_evtGatt->eventField.onClientCccdListChange.numOfCccd * 4U;
+    }
+    p_block = APP_BLE_EvtPool_Alloc(evtLen + cccdLen);
+    if (p_block == NULL)
     {
         return;
     }
-    (void)memcpy(stackEvent.p_event, p_stack->p_event, p_stack->evtLen);
-    stackEvent.p_event=stackEvent.p_event;
+    p_block->stackEvt.groupId = p_stack->groupId;
+    p_block->stackEvt.evtLen = p_stack->evtLen;
+    (void)memcpy(p_block->stackEvt.p_event, p_stack->p_event, p_stack->evtLen);
 
     if (p_stack->groupId==STACK_GRP_GATT)
     {
-        GATT_Event_T *p_evtGatt = (GATT_Event_T *)stackEvent.p_event;
+        p_evtGatt = (GATT_Event_T *)p_block->stackEvt.p_event;
 
-        if (p_evtGatt->eventId == GATTS_EVT_CLIENT_CCCDLIST_CHANGE)
+        if (cccdLen != 0U)
         {
-            uint8_t *p_payload;
-
-            p_payload = (uint8_t *)OSAL_Malloc((p_evtGatt->eventField.onClientCccdListChange.numOfCccd*4));
-            if (p_payload != NULL)
-            {
-                (void)memcpy(p_payload, (uint8_t *)p_evtGatt->eventField.onClientCccdListChange.p_cccdList, (p_evtGatt->eventField.onClientCccdListChange.numOfCccd*4));
-                p_evtGatt->eventField.onClientCccdListChange.p_cccdList = (GATTS_CccdList_T *)p_payload;
-            }
+            uint8_t *p_payload = &p_block->stackEvt.p_event[evtLen];
+
+            (void)memcpy(p_payload, (uint8_t *)p_evtGatt->eventField.onClientCccdListChange.p_cccdList, cccdLen);
+            p_evtGatt->eventField.onClientCccdListChange.p_cccdList = (GATTS_CccdList_T *)p_payload;
+        }
+        else if ((p_evtGatt->eventId == GATTS_EVT_WRITE) && (p_evtGatt->eventField.onWrite.attrHandle == CTRL_HDL_CHARVAL_0))
+        {
+            // control writes are timed until they reach the PWM
+            p_block->traceStamp = receivedStamp;
         }
     }
 
     appMsg.msgId=APP_MSG_BLE_STACK_EVT;
-
-    ((STACK_Event_T *)appMsg.msgData)->groupId=p_stack->groupId;
-    ((STACK_Event_T *)appMsg.msgData)->evtLen=p_stack->evtLen;
-    ((STACK_Event_T *)appMsg.msgData)->p_event=stackEvent.p_event;
-
-    p_appMsg = &appMsg;
-    OSAL_QUEUE_Send(&appData.appQueue, p_appMsg, 0);
+    appMsg.p_block = p_block;
+    if (OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0) != OSAL_RESULT_TRUE)
+    {
+        APP_BLE_EvtPool_Free(p_block);
+    }
 }
 
 void APP_BleStackEvtHandler(STACK_Event_T *p_stackEvt)
@@ -173,9 +225,6 @@ void APP_BleStackEvtHandler(STACK_Event_T *p_stackEvt)
 
     //Direct event to BLE profiles
     BLE_GDMC_BleEventHandler(p_stackEvt);
-
-
-    OSAL_Free(p_stackEvt->p_event);
 }
 
 
@@ -183,10 +232,12 @@ void APP_BleStackEvtHandler(STACK_Event_T *p_stackEvt)
 static void APP_BleConfigBasic(void)
 {
     int8_t                          connTxPower;
+#if APP_BLE_PERI_ADV_EXTENDED
+    // Configure the extended advertising sets, legacy commands are refused from now on
+    APP_BLE_PeriAdv_Config();
+#else
     int8_t                          advTxPower;
     BLE_GAP_AdvParams_T             advParam;
-    uint8_t advData[]=CONFIG_BLE_GAP_ADV_DATA;
-    BLE_GAP_AdvDataParams_T         appAdvData;
 
 
     // Configure advertising parameters
@@ -199,11 +250,10 @@ static void APP_BleConfigBasic(void)
     advParam.advChannelMap = CONFIG_BLE_GAP_ADV_CHANNEL_MAP;        /* Advertising Channel Map */
     advParam.filterPolicy = CONFIG_BLE_GAP_ADV_FILT_POLICY;     /* Advertising Filter Policy */
     BLE_GAP_SetAdvParams(&advParam);
+#endif
 
-    // Configure advertising data
-    appAdvData.advLen = CONFIG_BLE_GAP_ADV_DATA_ORIG_LEN;
-    (void)memcpy(appAdvData.advData, advData, appAdvData.advLen);     /* Advertising Data */
-    BLE_GAP_SetAdvData(&appAdvData);
+    // Configure advertising data, followed by the motor status
+    APP_BLE_Adv_Init();
 
     BLE_GAP_Addr_T devAddr;
     devAddr.addrType = BLE_GAP_ADDR_TYPE_PUBLIC;
@@ -226,7 +276,9 @@ static void APP_BleConfigAdvance(void)
 
     BLE_SMP_Config_T                smpParam;
 
+#if !APP_BLE_PERI_ADV_EXTENDED
     BLE_GAP_ScanningParams_T        scanParam;
+#endif
     BLE_DM_Config_T                 dmConfig;
     BLE_GAP_ServiceOption_T         gapServiceOptions;
 
@@ -243,6 +295,7 @@ static void APP_BleConfigAdvance(void)
     gapServiceOptions.charLeGattSecLvls.enable = CONFIG_BLE_GAP_SVC_LE_GATT_SEC_LVLS;                     /* Enable LE GATT Security Levels */
     BLE_GAP_ConfigureBuildInService(&gapServiceOptions);
 
+#if !APP_BLE_PERI_ADV_EXTENDED
     // Configure scan parameters
     scanParam.type = CONFIG_BLE_GAP_SCAN_TYPE;      /* Scan Type */
     scanParam.interval = CONFIG_BLE_GAP_SCAN_INTERVAL;      /* Scan Interval */
@@ -250,6 +303,7 @@ static void APP_BleConfigAdvance(void)
     scanParam.filterPolicy = CONFIG_BLE_GAP_SCAN_FILT_POLICY;       /* Scan Filter Policy */
     scanParam.disChannel = CONFIG_BLE_GAP_SCAN_DIS_CHANNEL_MAP;      /* Disable specific channel during scanning */
     BLE_GAP_SetScanningParam(&scanParam);
+#endif
 
 
     // Configure SMP parameters
@@ -278,6 +332,10 @@ void APP_BleStackInitBasic(void)
 
     BLE_GAP_AdvInit();  /* Advertising */
 
+#if APP_BLE_PERI_ADV_EXTENDED
+    APP_BLE_PeriAdv_InitAdv();  /* Extended and periodic advertising */
+#endif
+
     BLE_GAP_ConnPeripheralInit();   /* Peripheral */
 
 }
@@ -294,20 +352,34 @@ void APP_BleStackInitAdvance(void)
 
     BLE_GAP_ScanInit();     /* Scan */
 
+#if APP_BLE_PERI_ADV_EXTENDED
+    APP_BLE_PeriAdv_InitScan();     /* Extended scan and periodic sync */
+#endif
+
     BLE_GAP_ConnCentralInit();  /* Central */
 
+#if APP_BLE_PERI_ADV_EXTENDED
+    APP_BLE_PeriAdv_InitConn();     /* Extended create connection */
+#endif
+
     /* GAP (BLE_GAP_Init())shall be initialized before SMP */
     BLE_SMP_Init();
 
     /* GAP/SMP shall be initialized before L2CAP */
     BLE_L2CAP_Init();
 
+    /* Credit based channel for bulk transfers */
+    APP_BLE_Bulk_Init();
+
     /* GAP/SMP/L2CAP shall be initialized before GATTS */
     GATTS_Init(gattsInitParam);
 
     /* GATTS shall be initialized before GATTC */
     GATTC_Init(gattcInitParam);     /* Enable Client Role */
 
+    /* Answer an MTU exchange with the largest MTU in either role */
+    GATTS_SetPreferredMtu(BLE_ATT_MAX_MTU_LEN, BLE_ATT_MAX_MTU_LEN);
+
 
     //Initialize BLE middleware
     BLE_DM_Init();
@@ -324,6 +396,7 @@ void APP_BleStackInitAdvance(void)
     
     // Add profile for head unit as peripheral to allow mobile to connect/control
     BLE_MobileCtrl_Add();
+    APP_CtrlSvcCheck();
 
     // Initialize Garage Door Motor Control Service for other peripherals to control
     BLE_GDMC_Init();
@@ -0,0 +1,150 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Advertising Data Filter Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_ad_filter.c
+
+  Summary:
+    This file contains the single pass match of advertising data against a
+    scan filter.
+
+  Description:
+    This file contains the walk over the AD structures of a report. Every
+    structure is checked against the reported length before its type is
+    read, a zero length ends the significant part as in the Core
+    specification.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "app_ble_ad_filter.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+static bool APP_BLE_AdFilter_Uuid16(const APP_BLE_AdFilter_T *p_filter, const uint8_t *p_value, uint8_t valueLen)
+{
+    uint8_t i;
+    uint8_t j;
+
+    // a trailing odd byte is not a UUID
+    for (i = 0U; (i + 1U) < valueLen; i += 2U)
+    {
+        uint16_t uuid = (uint16_t)p_value[i] | ((uint16_t)p_value[i + 1U] << 8);
+
+        for (j = 0U; j < p_filter->uuid16Num; j++)
+        {
+            if (p_filter->p_uuid16[j] == uuid)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+uint8_t APP_BLE_AdFilter_Match(const APP_BLE_AdFilter_T *p_filter, const uint8_t *p_data, uint16_t len)
+{
+    uint16_t offset = 0U;
+    uint8_t matched = 0U;
+    uint8_t pending = p_filter->require;
+
+    while ((pending != 0U) && (offset < len))
+    {
+        uint8_t adLen = p_data[offset];
+        const uint8_t *p_value;
+        uint8_t valueLen;
+
+        if ((adLen == 0U) || (adLen > (len - offset - 1U)))
+        {
+            // end of significant part, or a structure cut off by the report
+            break;
+        }
+        p_value = &p_data[offset + 2U];
+        valueLen = adLen - 1U;
+
+        switch (p_data[offset + 1U])
+        {
+            case APP_BLE_AD_TYPE_UUID16_INCOMPLETE:
+            case APP_BLE_AD_TYPE_UUID16_COMPLETE:
+            {
+                if (((pending & APP_BLE_AD_MATCH_UUID16) != 0U) && APP_BLE_AdFilter_Uuid16(p_filter, p_value, valueLen))
+                {
+                    matched |= APP_BLE_AD_MATCH_UUID16;
+                }
+            }
+            break;
+
+            case APP_BLE_AD_TYPE_SHORT_NAME:
+            case APP_BLE_AD_TYPE_COMPLETE_NAME:
+            {
+                if (((pending & APP_BLE_AD_MATCH_NAME) != 0U) && (valueLen >= p_filter->namePrefixLen) &&
+                    (memcmp(p_value, p_filter->p_namePrefix, p_filter->namePrefixLen) == 0))
+                {
+                    matched |= APP_BLE_AD_MATCH_NAME;
+                }
+            }
+            break;
+
+            case APP_BLE_AD_TYPE_MANUFACTURER:
+            {
+                if (((pending & APP_BLE_AD_MATCH_COMPANY) != 0U) && (valueLen >= 2U) &&
+                    (p_value[0] == (uint8_t)p_filter->companyId) && (p_value[1] == (uint8_t)(p_filter->companyId >> 8)))
+                {
+                    matched |= APP_BLE_AD_MATCH_COMPANY;
+                }
+            }
+            break;
+
+            default:
+            break;
+        }
+        pending = p_filter->require & (uint8_t)~matched;
+        offset += (uint16_t)adLen + 1U;
+    }
+    return matched;
+}
+
+bool APP_BLE_AdFilter_IsMatch(const APP_BLE_AdFilter_T *p_filter, const uint8_t *p_data, uint16_t len)
+{
+    return ((p_filter->require != 0U) && (APP_BLE_AdFilter_Match(p_filter, p_data, len) == p_filter->require));
+}
+
+/* *****************************************************************************
+ End of File
+ */
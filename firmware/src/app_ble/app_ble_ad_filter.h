@@ -0,0 +1,132 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Advertising Data Filter Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_ad_filter.h
+
+  Summary:
+    This header file provides the matching of received advertising data
+    against a scan filter.
+
+  Description:
+    A filter names the AD fields a device must advertise: one of a list of
+    16-bit service UUIDs, a local name prefix and a manufacturer company
+    identifier. Lengths are fixed when the filter is defined, normally as a
+    const object built with the APP_BLE_AD_FILTER_* macros, so nothing is
+    measured while reports arrive.
+
+    APP_BLE_AdFilter_Match() walks the AD structures of a report once,
+    never reads past the reported length or past the structure being
+    looked at, and returns as soon as every required field was found.
+*******************************************************************************/
+
+#ifndef APP_BLE_AD_FILTER_H
+#define APP_BLE_AD_FILTER_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+/**@brief AD types, Bluetooth assigned numbers. */
+#define APP_BLE_AD_TYPE_FLAGS               (0x01U)
+#define APP_BLE_AD_TYPE_UUID16_INCOMPLETE   (0x02U)
+#define APP_BLE_AD_TYPE_UUID16_COMPLETE     (0x03U)
+#define APP_BLE_AD_TYPE_UUID128_COMPLETE    (0x07U)
+#define APP_BLE_AD_TYPE_SHORT_NAME          (0x08U)
+#define APP_BLE_AD_TYPE_COMPLETE_NAME       (0x09U)
+#define APP_BLE_AD_TYPE_MANUFACTURER        (0xFFU)
+
+/**@brief Fields of a filter, combined in APP_BLE_AdFilter_T.require and in the match result. */
+#define APP_BLE_AD_MATCH_UUID16             (0x01U)
+#define APP_BLE_AD_MATCH_NAME               (0x02U)
+#define APP_BLE_AD_MATCH_COMPANY            (0x04U)
+
+/**@brief Name prefix of a filter from a string literal. */
+#define APP_BLE_AD_FILTER_NAME(str)         .p_namePrefix = (const uint8_t *)(str), \
+                                            .namePrefixLen = (uint8_t)(sizeof(str) - 1U)
+
+/**@brief UUID list of a filter from an array. */
+#define APP_BLE_AD_FILTER_UUID16(array)     .p_uuid16 = (array), \
+                                            .uuid16Num = (uint8_t)(sizeof(array) / sizeof((array)[0]))
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+/**@brief Scan filter, all fields in require must be present. */
+typedef struct APP_BLE_AdFilter_T
+{
+    uint8_t             require;            /* APP_BLE_AD_MATCH_* */
+    uint8_t             uuid16Num;
+    const uint16_t      *p_uuid16;          /* any of them matches */
+    uint8_t             namePrefixLen;
+    const uint8_t       *p_namePrefix;      /* complete or shortened name starting with it */
+    uint16_t            companyId;
+} APP_BLE_AdFilter_T;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+uint8_t APP_BLE_AdFilter_Match(const APP_BLE_AdFilter_T *p_filter, const uint8_t *p_data, uint16_t len);
+bool APP_BLE_AdFilter_IsMatch(const APP_BLE_AdFilter_T *p_filter, const uint8_t *p_data, uint16_t len);
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif /* APP_BLE_AD_FILTER_H */
+
+/*******************************************************************************
+ End of File
+ */
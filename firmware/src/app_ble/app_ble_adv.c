@@ -0,0 +1,144 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Advertising Status Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_adv.c
+
+  Summary:
+    This file contains the advertising data with the motor status.
+
+  Description:
+    This file contains the encoding of the status AD structure and the
+    comparison that keeps unchanged data away from the stack.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "configuration.h"
+#include "ble_gap.h"
+#include "app_ble_adv.h"
+#include "app_ble_ad_filter.h"
+#include "app_ble_peri_adv.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+/* The change counter is the last byte, the content compared is before it */
+#define APP_BLE_ADV_COUNTER_OFFSET          (APP_BLE_ADV_STATUS_LEN - 1U)
+
+static BLE_GAP_AdvDataParams_T  s_advData;
+static uint8_t                  *sp_status;         /* status AD structure inside s_advData */
+static uint8_t                  s_changeCounter;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+static void APP_BLE_Adv_Apply(void)
+{
+#if APP_BLE_PERI_ADV_EXTENDED
+    (void)APP_BLE_PeriAdv_SetConnData(s_advData.advData, s_advData.advLen);
+#else
+    (void)BLE_GAP_SetAdvData(&s_advData);
+#endif
+}
+
+static void APP_BLE_Adv_Encode(const motorTlmRecord_t *p_rec, uint8_t *p_status)
+{
+    int32_t rpm = p_rec->rpmQ16 / 65536;
+
+    if (rpm > INT16_MAX)
+    {
+        rpm = INT16_MAX;
+    }
+    else if (rpm < INT16_MIN)
+    {
+        rpm = INT16_MIN;
+    }
+    p_status[0] = (uint8_t)(APP_BLE_ADV_STATUS_LEN - 1U);
+    p_status[1] = APP_BLE_AD_TYPE_MANUFACTURER;
+    p_status[2] = (uint8_t)APP_BLE_ADV_COMPANY_ID;
+    p_status[3] = (uint8_t)(APP_BLE_ADV_COMPANY_ID >> 8);
+    p_status[4] = APP_BLE_ADV_STATUS_VERSION;
+    p_status[5] = p_rec->state;
+    p_status[6] = (uint8_t)rpm;
+    p_status[7] = (uint8_t)((uint32_t)rpm >> 8);
+    p_status[8] = p_rec->flags;
+}
+
+void APP_BLE_Adv_Init(void)
+{
+    uint8_t advData[] = CONFIG_BLE_GAP_ADV_DATA;
+    motorTlmRecord_t record;
+
+    s_advData.advLen = CONFIG_BLE_GAP_ADV_DATA_ORIG_LEN;
+    (void)memcpy(s_advData.advData, advData, s_advData.advLen);
+    if ((s_advData.advLen + APP_BLE_ADV_STATUS_LEN) <= BLE_GAP_ADV_MAX_LENGTH)
+    {
+        sp_status = &s_advData.advData[s_advData.advLen];
+        (void)memset(&record, 0, sizeof(record));
+        APP_BLE_Adv_Encode(&record, sp_status);
+        sp_status[APP_BLE_ADV_COUNTER_OFFSET] = s_changeCounter;
+        s_advData.advLen += APP_BLE_ADV_STATUS_LEN;
+    }
+    APP_BLE_Adv_Apply();
+}
+
+void APP_BLE_Adv_UpdateStatus(const motorTlmRecord_t *p_rec)
+{
+    uint8_t status[APP_BLE_ADV_STATUS_LEN];
+
+    if (sp_status == NULL)
+    {
+        // the configured data leaves no room
+        return;
+    }
+    APP_BLE_Adv_Encode(p_rec, status);
+    if (memcmp(status, sp_status, APP_BLE_ADV_COUNTER_OFFSET) == 0)
+    {
+        return;
+    }
+    (void)memcpy(sp_status, status, APP_BLE_ADV_COUNTER_OFFSET);
+    sp_status[APP_BLE_ADV_COUNTER_OFFSET] = ++s_changeCounter;
+    APP_BLE_Adv_Apply();
+}
+
+/* *****************************************************************************
+ End of File
+ */
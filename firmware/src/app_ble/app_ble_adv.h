@@ -0,0 +1,112 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Advertising Status Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_adv.h
+
+  Summary:
+    This header file provides the motor status carried in the advertising
+    data.
+
+  Description:
+    The configured advertising data (flags, name, service UUID) is followed by
+    a manufacturer specific AD structure, so a scanner can read the motor
+    status without connecting:
+
+      Offset  Size  Field
+       0      1     AD length, 9
+       1      1     AD type, manufacturer specific data
+       2      2     company identifier, APP_BLE_ADV_COMPANY_ID
+       4      1     version, APP_BLE_ADV_STATUS_VERSION
+       5      1     state, motorState_t
+       6      2     speed, signed RPM, positive is forward, saturated
+       8      1     flags, MOTOR_TLM_FLAG_*
+       9      1     change counter, increments with every new content
+
+    The status is refreshed from the application task once a second and the
+    stack is only given new data when the content differs from what is on
+    the air. Passive scanners see it, no scan request is needed.
+*******************************************************************************/
+
+#ifndef APP_BLE_ADV_H
+#define APP_BLE_ADV_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motor_telemetry.h"
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+/**@brief Bluetooth SIG company identifier of Microchip Technology Inc. */
+#define APP_BLE_ADV_COMPANY_ID          (0x00CDU)
+
+/**@brief Layout version of the status payload. */
+#define APP_BLE_ADV_STATUS_VERSION      (1U)
+
+/**@brief Length of the manufacturer specific AD structure including its length byte. */
+#define APP_BLE_ADV_STATUS_LEN          (10U)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+void APP_BLE_Adv_Init(void);
+void APP_BLE_Adv_UpdateStatus(const motorTlmRecord_t *p_rec);
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif /* APP_BLE_ADV_H */
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,302 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Bulk Channel Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_bulk.c
+
+  Summary:
+    This file contains the LE credit based L2CAP channel used for bulk
+    transfers.
+
+  Description:
+    This file contains the SPSM registration, the channel events and the
+    credit accounting for SDUs sent to the phone.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "configuration.h"
+#include "system/console/sys_console.h"
+#include "app_ble_bulk.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static APP_BLE_BulkChannel_T    s_bulkChannel;
+
+/* A channel turned down while the stack had no buffer for the disconnect request */
+static bool                     s_rejectPending;
+static uint8_t                  s_rejectL2capId;
+
+
+/* Number of K-frames, and so credits, the stack needs for one SDU */
+static uint16_t APP_BLE_Bulk_Frames(uint16_t len)
+{
+    // the first K-frame also carries the 2 byte SDU length
+    return (uint16_t)((len + 2U + s_bulkChannel.remoteMps - 1U) / s_bulkChannel.remoteMps);
+}
+
+static void APP_BLE_Bulk_Reject(uint8_t leL2capId)
+{
+    if (BLE_L2CAP_CbDiscReq(leL2capId) == MBA_RES_SUCCESS)
+    {
+        s_rejectPending = false;
+        return;
+    }
+    // retried on the next free transmit buffer, a second reject only happens if the phone retries as well
+    s_rejectPending = true;
+    s_rejectL2capId = leL2capId;
+    s_bulkChannel.stats.rejectFails++;
+}
+
+/* Returns the credits of the received SDUs, whatever the stack could not take is kept for the next try */
+static void APP_BLE_Bulk_ReturnCredits(uint16_t credits)
+{
+    uint32_t total = (uint32_t)s_bulkChannel.rxCreditsPending + credits;
+
+    if (total > 0xFFFFU)
+    {
+        total = 0xFFFFU;
+    }
+    if (BLE_L2CAP_CbAddCredits(s_bulkChannel.leL2capId, (uint16_t)total) == MBA_RES_SUCCESS)
+    {
+        s_bulkChannel.rxCreditsPending = 0;
+        return;
+    }
+    s_bulkChannel.rxCreditsPending = (uint16_t)total;
+    s_bulkChannel.stats.creditReturnFails++;
+}
+
+static void APP_BLE_Bulk_Close(void)
+{
+    APP_BLE_BulkStats_T *p_stats = &s_bulkChannel.stats;
+
+    if (s_bulkChannel.open)
+    {
+        SYS_CONSOLE_PRINT("Bulk channel closed, sent %lu SDU %lu bytes, stalls credit %lu buffer %lu, failed credit returns %lu rejects %lu\r\n",
+            (unsigned long)p_stats->sduSent, (unsigned long)p_stats->bytesSent,
+            (unsigned long)p_stats->creditStalls, (unsigned long)p_stats->bufferStalls,
+            (unsigned long)p_stats->creditReturnFails, (unsigned long)p_stats->rejectFails);
+    }
+    memset(&s_bulkChannel, 0, sizeof(s_bulkChannel));
+}
+
+uint16_t APP_BLE_Bulk_Init(void)
+{
+    uint16_t result;
+
+    memset(&s_bulkChannel, 0, sizeof(s_bulkChannel));
+    s_rejectPending = false;
+    result = BLE_L2CAP_CbInit();
+    if (result == MBA_RES_SUCCESS)
+    {
+        result = BLE_L2CAP_CbRegisterSpsm(APP_BLE_BULK_SPSM, APP_BLE_BULK_MTU, APP_BLE_BULK_MPS,
+                                          APP_BLE_BULK_RX_CREDITS, BLE_L2CAP_PERMISSION_NONE);
+    }
+    return result;
+}
+
+void APP_BLE_Bulk_L2capEvtHandler(BLE_L2CAP_Event_T *p_event)
+{
+    switch(p_event->eventId)
+    {
+        case BLE_L2CAP_EVT_CB_CONN_IND:
+        {
+            BLE_L2CAP_EvtCbConnInd_T *p_conn = &p_event->eventField.evtCbConnInd;
+
+            if ((p_conn->spsm != APP_BLE_BULK_SPSM) || s_bulkChannel.open)
+            {
+                // one bulk channel is enough, turn down any other
+                APP_BLE_Bulk_Reject(p_conn->leL2capId);
+                break;
+            }
+            memset(&s_bulkChannel, 0, sizeof(s_bulkChannel));
+            s_bulkChannel.open = true;
+            s_bulkChannel.leL2capId = p_conn->leL2capId;
+            s_bulkChannel.connHandle = p_conn->connHandle;
+            s_bulkChannel.remoteMtu = p_conn->remoteMtu;
+            s_bulkChannel.remoteMps = (p_conn->remoteMps < BLE_L2CAP_MIN_MPS_SIZE) ? BLE_L2CAP_MIN_MPS_SIZE : p_conn->remoteMps;
+            s_bulkChannel.txCredits = p_conn->initialCredits;
+            SYS_CONSOLE_PRINT("Bulk channel open, MTU %d MPS %d credits %d\r\n",
+                p_conn->remoteMtu, p_conn->remoteMps, p_conn->initialCredits);
+        }
+        break;
+
+        case BLE_L2CAP_EVT_CB_CONN_FAIL_IND:
+        {
+            SYS_CONSOLE_PRINT("Bulk channel failed %d\r\n", p_event->eventField.evtCbConnFailInd.result);
+        }
+        break;
+
+        case BLE_L2CAP_EVT_CB_SDU_IND:
+        {
+            BLE_L2CAP_EvtCbSduInd_T *p_sdu = &p_event->eventField.evtCbSduInd;
+
+            if (!s_bulkChannel.open || (p_sdu->leL2capId != s_bulkChannel.leL2capId))
+            {
+                break;
+            }
+            s_bulkChannel.stats.sduReceived++;
+            // nothing is read from the phone on this channel yet, hand the credits straight back
+            APP_BLE_Bulk_ReturnCredits(p_sdu->frames);
+        }
+        break;
+
+        case BLE_L2CAP_EVT_CB_ADD_CREDITS_IND:
+        {
+            BLE_L2CAP_EvtCbAddCreditsInd_T *p_credits = &p_event->eventField.evtCbAddCreditsInd;
+
+            if (s_bulkChannel.open && (p_credits->leL2capId == s_bulkChannel.leL2capId))
+            {
+                // the spec caps the credit count at 65535
+                if (p_credits->credits > (0xFFFFU - s_bulkChannel.txCredits))
+                {
+                    s_bulkChannel.txCredits = 0xFFFFU;
+                }
+                else
+                {
+                    s_bulkChannel.txCredits += p_credits->credits;
+                }
+            }
+        }
+        break;
+
+        case BLE_L2CAP_EVT_CB_DISC_IND:
+        {
+            uint8_t leL2capId = p_event->eventField.evtCbDiscInd.leL2capId;
+
+            if (s_rejectPending && (leL2capId == s_rejectL2capId))
+            {
+                // the phone gave up on the rejected channel first
+                s_rejectPending = false;
+            }
+            if (s_bulkChannel.open && (leL2capId == s_bulkChannel.leL2capId))
+            {
+                APP_BLE_Bulk_Close();
+            }
+        }
+        break;
+
+        default:
+        break;
+    }
+}
+
+void APP_BLE_Bulk_Disconnected(uint16_t connHandle)
+{
+    if (s_bulkChannel.open && (s_bulkChannel.connHandle == connHandle))
+    {
+        APP_BLE_Bulk_Close();
+    }
+}
+
+bool APP_BLE_Bulk_TxBufAvailable(uint16_t connHandle)
+{
+    bool resume;
+
+    if (s_rejectPending)
+    {
+        APP_BLE_Bulk_Reject(s_rejectL2capId);
+    }
+    if (!s_bulkChannel.open || (s_bulkChannel.connHandle != connHandle))
+    {
+        return false;
+    }
+    if (s_bulkChannel.rxCreditsPending != 0U)
+    {
+        APP_BLE_Bulk_ReturnCredits(0);
+    }
+    resume = s_bulkChannel.txStalled;
+    s_bulkChannel.txStalled = false;
+    return resume;
+}
+
+bool APP_BLE_Bulk_IsOpen(void)
+{
+    return s_bulkChannel.open;
+}
+
+uint16_t APP_BLE_Bulk_MaxSdu(void)
+{
+    if (!s_bulkChannel.open)
+    {
+        return 0;
+    }
+    return (s_bulkChannel.remoteMtu < BLE_L2CAP_MAX_SDU_SIZE) ? s_bulkChannel.remoteMtu : BLE_L2CAP_MAX_SDU_SIZE;
+}
+
+bool APP_BLE_Bulk_Send(uint8_t *p_data, uint16_t len)
+{
+    uint16_t frames;
+    uint16_t result;
+
+    if (!s_bulkChannel.open || (len == 0U) || (len > APP_BLE_Bulk_MaxSdu()))
+    {
+        return false;
+    }
+    if (s_bulkChannel.rxCreditsPending != 0U)
+    {
+        APP_BLE_Bulk_ReturnCredits(0);
+    }
+    frames = APP_BLE_Bulk_Frames(len);
+    if (frames > s_bulkChannel.txCredits)
+    {
+        s_bulkChannel.stats.creditStalls++;
+        return false;
+    }
+    result = BLE_L2CAP_CbSendSdu(s_bulkChannel.leL2capId, len, p_data);
+    if (result != MBA_RES_SUCCESS)
+    {
+        // BLE_GAP_EVT_TX_BUF_AVAILABLE resumes the sender, see APP_BLE_Bulk_TxBufAvailable()
+        s_bulkChannel.txStalled = true;
+        s_bulkChannel.stats.bufferStalls++;
+        return false;
+    }
+    s_bulkChannel.txCredits -= frames;
+    s_bulkChannel.stats.sduSent++;
+    s_bulkChannel.stats.bytesSent += len;
+    return true;
+}
+
+const APP_BLE_BulkChannel_T *APP_BLE_Bulk_GetChannel(void)
+{
+    return &s_bulkChannel;
+}
+
+/* *****************************************************************************
+ End of File
+ */
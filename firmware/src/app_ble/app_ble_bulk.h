@@ -0,0 +1,154 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Bulk Channel Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_bulk.h
+
+  Summary:
+    This header file provides the LE credit based L2CAP channel used for bulk
+    transfers to the phone.
+
+  Description:
+    The phone opens a credit based channel on APP_BLE_BULK_SPSM. While the
+    channel is open, large payloads such as the telemetry stream are sent as
+    L2CAP SDUs rather than ATT notifications, so there is no per-packet ATT
+    header and one SDU can be larger than the ATT MTU.
+
+    The stack splits every SDU into K-frames of at most the peer MPS and each
+    K-frame uses one of the credits the peer granted. Credits are counted
+    here so an SDU is only handed to the stack when all of its K-frames can
+    go out, otherwise the caller keeps the data and tries again later.
+    Credits for received SDUs are returned as soon as the SDU is consumed.
+
+    Calls the stack refuses for want of a transmit buffer, a send, a credit
+    return or the rejection of a second channel, are retried from
+    APP_BLE_Bulk_TxBufAvailable() on BLE_GAP_EVT_TX_BUF_AVAILABLE, which
+    returns true when the sender should try again.
+
+    All functions run in the application task that handles the BLE stack
+    events.
+*******************************************************************************/
+
+#ifndef APP_BLE_BULK_H
+#define APP_BLE_BULK_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mba_error_defs.h"
+#include "ble_l2cap.h"
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+/**@brief SPSM the phone connects to, taken from the dynamic range. */
+#define APP_BLE_BULK_SPSM               (0x0081U)
+
+/**@brief Largest SDU accepted from the peer. */
+#define APP_BLE_BULK_MTU                (BLE_L2CAP_MAX_SDU_SIZE)
+
+/**@brief Largest K-frame payload accepted from the peer, one full LE data PDU. */
+#define APP_BLE_BULK_MPS                (247U)
+
+/**@brief Credits granted to the peer when the channel opens. */
+#define APP_BLE_BULK_RX_CREDITS         (4U)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+/**@brief Bulk channel counters. */
+typedef struct APP_BLE_BulkStats_T
+{
+    uint32_t                sduSent;                                        /**< SDUs accepted by the stack. */
+    uint32_t                bytesSent;                                      /**< SDU payload bytes accepted by the stack. */
+    uint32_t                creditStalls;                                   /**< Sends refused because the peer had not granted enough credits. */
+    uint32_t                bufferStalls;                                   /**< Sends refused because the stack had no transmit buffer. */
+    uint32_t                sduReceived;                                    /**< SDUs received from the peer. */
+    uint32_t                creditReturnFails;                              /**< Credit returns the stack refused, the credits are returned later. */
+    uint32_t                rejectFails;                                    /**< Channel rejections the stack refused, the rejection is sent later. */
+} APP_BLE_BulkStats_T;
+
+/**@brief State of the bulk channel. */
+typedef struct APP_BLE_BulkChannel_T
+{
+    bool                    open;                                           /**< Channel is connected. */
+    uint8_t                 leL2capId;                                      /**< L2CAP instance of the channel. */
+    uint16_t                connHandle;                                     /**< Connection carrying the channel. */
+    uint16_t                remoteMtu;                                      /**< Largest SDU the peer accepts. */
+    uint16_t                remoteMps;                                      /**< Largest K-frame payload the peer accepts. */
+    uint16_t                txCredits;                                      /**< K-frames the peer still allows us to send. */
+    uint16_t                rxCreditsPending;                               /**< Credits of received SDUs not yet returned to the peer. */
+    bool                    txStalled;                                      /**< A send failed for want of a transmit buffer. */
+    APP_BLE_BulkStats_T     stats;                                          /**< See @ref APP_BLE_BulkStats_T. */
+} APP_BLE_BulkChannel_T;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+uint16_t APP_BLE_Bulk_Init(void);
+void APP_BLE_Bulk_L2capEvtHandler(BLE_L2CAP_Event_T *p_event);
+void APP_BLE_Bulk_Disconnected(uint16_t connHandle);
+bool APP_BLE_Bulk_TxBufAvailable(uint16_t connHandle);
+bool APP_BLE_Bulk_IsOpen(void);
+uint16_t APP_BLE_Bulk_MaxSdu(void);
+bool APP_BLE_Bulk_Send(uint8_t *p_data, uint16_t len);
+const APP_BLE_BulkChannel_T *APP_BLE_Bulk_GetChannel(void);
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif /* APP_BLE_BULK_H */
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,196 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Connection Parameter Policy Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_conn_policy.c
+
+  Summary:
+    This file contains the connection parameter policy of the links to the
+    phones.
+
+  Description:
+    This file contains the profile selection with its hysteresis and the
+    update requests made through the BLE device manager.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "ble_dm/ble_dm.h"
+#include "app_ble_conn_policy.h"
+
+
+/* Profile an interval belongs to, any interval in between is the phone's own */
+static uint8_t APP_BLE_ConnPolicy_Classify(uint16_t connInterval)
+{
+    if (connInterval <= APP_BLE_CONN_FAST_INTERVAL_MAX)
+    {
+        return (uint8_t)APP_BLE_CONN_PROFILE_FAST;
+    }
+    if (connInterval >= APP_BLE_CONN_IDLE_INTERVAL_MIN)
+    {
+        return (uint8_t)APP_BLE_CONN_PROFILE_IDLE;
+    }
+    return (uint8_t)APP_BLE_CONN_PROFILE_PEER;
+}
+
+/* Asks the phone for the target profile unless a request is already out or on hold */
+static void APP_BLE_ConnPolicy_Request(APP_BLE_ConnPolicy_T *p_policy, uint16_t connHandle)
+{
+    BLE_DM_ConnParamUpdate_T params;
+
+    if ((p_policy->target == p_policy->current) || p_policy->settled || p_policy->pending || (p_policy->holdoff != 0U))
+    {
+        return;
+    }
+    if (p_policy->target == (uint8_t)APP_BLE_CONN_PROFILE_FAST)
+    {
+        params.intervalMin = APP_BLE_CONN_FAST_INTERVAL_MIN;
+        params.intervalMax = APP_BLE_CONN_FAST_INTERVAL_MAX;
+        params.latency = APP_BLE_CONN_FAST_LATENCY;
+        params.timeout = APP_BLE_CONN_FAST_TIMEOUT;
+    }
+    else
+    {
+        params.intervalMin = APP_BLE_CONN_IDLE_INTERVAL_MIN;
+        params.intervalMax = APP_BLE_CONN_IDLE_INTERVAL_MAX;
+        params.latency = APP_BLE_CONN_IDLE_LATENCY;
+        params.timeout = APP_BLE_CONN_IDLE_TIMEOUT;
+    }
+    p_policy->stats.requests++;
+    // the holdoff also bounds the wait for a result that never comes
+    p_policy->holdoff = APP_BLE_CONN_RETRY_HOLDOFF;
+    if (BLE_DM_ConnectionParameterUpdate(connHandle, &params) == MBA_RES_SUCCESS)
+    {
+        p_policy->pending = true;
+    }
+    else
+    {
+        p_policy->stats.failed++;
+    }
+}
+
+void APP_BLE_ConnPolicy_Init(APP_BLE_ConnPolicy_T *p_policy, uint16_t connInterval)
+{
+    memset(p_policy, 0, sizeof(APP_BLE_ConnPolicy_T));
+    p_policy->current = APP_BLE_ConnPolicy_Classify(connInterval);
+    // start as if active, the first ticks decide
+    p_policy->target = (uint8_t)APP_BLE_CONN_PROFILE_FAST;
+}
+
+void APP_BLE_ConnPolicy_Activity(APP_BLE_ConnPolicy_T *p_policy, uint16_t connHandle)
+{
+    p_policy->quietSeconds = 0;
+    if (p_policy->target != (uint8_t)APP_BLE_CONN_PROFILE_FAST)
+    {
+        // leaving idle is urgent, a held back idle request must not delay it
+        p_policy->target = (uint8_t)APP_BLE_CONN_PROFILE_FAST;
+        p_policy->settled = false;
+        if (!p_policy->pending)
+        {
+            p_policy->holdoff = 0;
+        }
+    }
+    APP_BLE_ConnPolicy_Request(p_policy, connHandle);
+}
+
+void APP_BLE_ConnPolicy_Tick(APP_BLE_ConnPolicy_T *p_policy, uint16_t connHandle, bool active)
+{
+    if (p_policy->current == (uint8_t)APP_BLE_CONN_PROFILE_FAST)
+    {
+        p_policy->stats.fastSeconds++;
+    }
+    else if (p_policy->current == (uint8_t)APP_BLE_CONN_PROFILE_IDLE)
+    {
+        p_policy->stats.idleSeconds++;
+    }
+
+    if (p_policy->holdoff != 0U)
+    {
+        p_policy->holdoff--;
+        if ((p_policy->holdoff == 0U) && p_policy->pending)
+        {
+            // no answer, give up on this one
+            p_policy->pending = false;
+            p_policy->stats.failed++;
+        }
+    }
+
+    if (active)
+    {
+        APP_BLE_ConnPolicy_Activity(p_policy, connHandle);
+        return;
+    }
+    if (p_policy->quietSeconds < UINT8_MAX)
+    {
+        p_policy->quietSeconds++;
+    }
+    if ((p_policy->quietSeconds >= APP_BLE_CONN_IDLE_HOLD) && (p_policy->target != (uint8_t)APP_BLE_CONN_PROFILE_IDLE))
+    {
+        p_policy->target = (uint8_t)APP_BLE_CONN_PROFILE_IDLE;
+        p_policy->settled = false;
+    }
+    APP_BLE_ConnPolicy_Request(p_policy, connHandle);
+}
+
+void APP_BLE_ConnPolicy_Result(APP_BLE_ConnPolicy_T *p_policy, bool success)
+{
+    if (!p_policy->pending)
+    {
+        return;
+    }
+    p_policy->pending = false;
+    if (success)
+    {
+        // the phone may still pick an interval outside the profile, asking again would not change that
+        p_policy->stats.accepted++;
+        p_policy->holdoff = 0;
+        p_policy->settled = true;
+    }
+    else
+    {
+        // keep the holdoff so a refusing phone is not asked again right away
+        p_policy->stats.failed++;
+    }
+}
+
+void APP_BLE_ConnPolicy_Updated(APP_BLE_ConnPolicy_T *p_policy, uint16_t connInterval)
+{
+    p_policy->stats.updates++;
+    p_policy->current = APP_BLE_ConnPolicy_Classify(connInterval);
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,159 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Connection Parameter Policy Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_conn_policy.h
+
+  Summary:
+    This header file provides the connection parameter policy of the links
+    to the phones.
+
+  Description:
+    A phone keeps whatever connection interval it picked when it connected.
+    The policy asks for a short interval while the motor moves or is being
+    tuned, so commands and telemetry get through within one connection event,
+    and for a long interval with peripheral latency once it is idle, so the
+    radio sleeps.
+
+    Activity switches to the fast profile at once. The idle profile is only
+    requested after APP_BLE_CONN_IDLE_HOLD seconds without activity, so a
+    short pause between moves does not make the link flap. A request the
+    phone turns down is not repeated for APP_BLE_CONN_RETRY_HOLDOFF seconds.
+    A request the phone accepts settles the target even when the phone picks
+    an interval outside the profile, the next request waits for the target
+    to change.
+    The profile in use is taken from the parameters actually reported by the
+    stack, whoever started the update.
+
+    All functions run in the application task.
+*******************************************************************************/
+
+#ifndef APP_BLE_CONN_POLICY_H
+#define APP_BLE_CONN_POLICY_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+/**@brief Fast profile, 7.5 ms to 15 ms interval in 1.25 ms units, no latency, 2 s timeout. */
+#define APP_BLE_CONN_FAST_INTERVAL_MIN      (6U)
+#define APP_BLE_CONN_FAST_INTERVAL_MAX      (12U)
+#define APP_BLE_CONN_FAST_LATENCY           (0U)
+#define APP_BLE_CONN_FAST_TIMEOUT           (200U)
+
+/**@brief Idle profile, 100 ms to 150 ms interval, 4 events latency, 6 s timeout. */
+#define APP_BLE_CONN_IDLE_INTERVAL_MIN      (80U)
+#define APP_BLE_CONN_IDLE_INTERVAL_MAX      (120U)
+#define APP_BLE_CONN_IDLE_LATENCY           (4U)
+#define APP_BLE_CONN_IDLE_TIMEOUT           (600U)
+
+/**@brief Seconds without activity before the idle profile is requested. */
+#define APP_BLE_CONN_IDLE_HOLD              (5U)
+
+/**@brief Seconds before a request the phone refused or did not answer is repeated. */
+#define APP_BLE_CONN_RETRY_HOLDOFF          (30U)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+/**@brief Connection parameter profiles. */
+typedef enum APP_BLE_ConnProfile_T
+{
+    APP_BLE_CONN_PROFILE_PEER = 0,      /**< Parameters chosen by the phone, neither profile. */
+    APP_BLE_CONN_PROFILE_FAST,          /**< Short interval for control. */
+    APP_BLE_CONN_PROFILE_IDLE           /**< Long interval with latency for low power. */
+} APP_BLE_ConnProfile_T;
+
+/**@brief Connection parameter policy counters. */
+typedef struct APP_BLE_ConnPolicyStats_T
+{
+    uint32_t                requests;                                       /**< Update requests started. */
+    uint32_t                accepted;                                       /**< Requests the phone accepted. */
+    uint32_t                failed;                                         /**< Requests refused, rejected by the stack or unanswered. */
+    uint32_t                updates;                                        /**< Parameter changes reported by the stack. */
+    uint32_t                fastSeconds;                                    /**< Time spent in the fast profile. */
+    uint32_t                idleSeconds;                                    /**< Time spent in the idle profile. */
+} APP_BLE_ConnPolicyStats_T;
+
+/**@brief Connection parameter policy state of one link. */
+typedef struct APP_BLE_ConnPolicy_T
+{
+    uint8_t                 target;                                         /**< Profile the policy wants. See @ref APP_BLE_ConnProfile_T. */
+    uint8_t                 current;                                        /**< Profile of the parameters in use. See @ref APP_BLE_ConnProfile_T. */
+    bool                    pending;                                        /**< A request is waiting for its result. */
+    bool                    settled;                                        /**< The phone accepted a request for the target. */
+    uint8_t                 holdoff;                                        /**< Seconds before another request may start. */
+    uint8_t                 quietSeconds;                                   /**< Seconds since the last activity. */
+    APP_BLE_ConnPolicyStats_T stats;                                        /**< See @ref APP_BLE_ConnPolicyStats_T. */
+} APP_BLE_ConnPolicy_T;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+void APP_BLE_ConnPolicy_Init(APP_BLE_ConnPolicy_T *p_policy, uint16_t connInterval);
+void APP_BLE_ConnPolicy_Activity(APP_BLE_ConnPolicy_T *p_policy, uint16_t connHandle);
+void APP_BLE_ConnPolicy_Tick(APP_BLE_ConnPolicy_T *p_policy, uint16_t connHandle, bool active);
+void APP_BLE_ConnPolicy_Result(APP_BLE_ConnPolicy_T *p_policy, bool success);
+void APP_BLE_ConnPolicy_Updated(APP_BLE_ConnPolicy_T *p_policy, uint16_t connInterval);
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif /* APP_BLE_CONN_POLICY_H */
+
+/*******************************************************************************
+ End of File
+ */
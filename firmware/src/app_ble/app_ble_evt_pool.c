@@ -0,0 +1,108 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Event Pool Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_evt_pool.c
+
+  Summary:
+    This file contains the fixed block pools of the BLE stack events.
+
+  Description:
+    This file contains the block storage of the size classes and the OSAL
+    pool built on it.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stddef.h>
+#include "app_ble_evt_pool.h"
+
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+/* Block size in words, header plus data */
+#define APP_BLE_EVT_BLOCK_WORDS(size)   ((sizeof(APP_BLE_EvtBlock_T) + (size) + 3U) / 4U)
+
+static uint32_t s_smallBlocks[APP_BLE_EVT_POOL_SMALL_COUNT][APP_BLE_EVT_BLOCK_WORDS(APP_BLE_EVT_POOL_SMALL_SIZE)];
+static uint32_t s_mediumBlocks[APP_BLE_EVT_POOL_MEDIUM_COUNT][APP_BLE_EVT_BLOCK_WORDS(APP_BLE_EVT_POOL_MEDIUM_SIZE)];
+static uint32_t s_largeBlocks[APP_BLE_EVT_POOL_LARGE_COUNT][APP_BLE_EVT_BLOCK_WORDS(APP_BLE_EVT_POOL_LARGE_SIZE)];
+
+static OSAL_POOL_CLASS s_evtClasses[APP_BLE_EVT_POOL_CLASSES];
+static OSAL_POOL s_evtPool;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+void APP_BLE_EvtPool_Init(void)
+{
+    // an event no block holds is dropped, the stack task must not wait on the heap
+    OSAL_POOL_Create(&s_evtPool, s_evtClasses, APP_BLE_EVT_POOL_CLASSES, false);
+    OSAL_POOL_ClassSetup(&s_evtPool, 0, &s_smallBlocks[0][0],
+                         APP_BLE_EVT_BLOCK_WORDS(APP_BLE_EVT_POOL_SMALL_SIZE) * 4U, APP_BLE_EVT_POOL_SMALL_COUNT);
+    OSAL_POOL_ClassSetup(&s_evtPool, 1, &s_mediumBlocks[0][0],
+                         APP_BLE_EVT_BLOCK_WORDS(APP_BLE_EVT_POOL_MEDIUM_SIZE) * 4U, APP_BLE_EVT_POOL_MEDIUM_COUNT);
+    OSAL_POOL_ClassSetup(&s_evtPool, 2, &s_largeBlocks[0][0],
+                         APP_BLE_EVT_BLOCK_WORDS(APP_BLE_EVT_POOL_LARGE_SIZE) * 4U, APP_BLE_EVT_POOL_LARGE_COUNT);
+}
+
+APP_BLE_EvtBlock_T *APP_BLE_EvtPool_Alloc(uint16_t dataLen)
+{
+    APP_BLE_EvtBlock_T *p_block = OSAL_POOL_Get(&s_evtPool, sizeof(APP_BLE_EvtBlock_T) + dataLen);
+
+    if (p_block != NULL)
+    {
+        p_block->stackEvt.p_event = (uint8_t *)p_block->data;
+        p_block->traceStamp = 0;
+    }
+    return p_block;
+}
+
+void APP_BLE_EvtPool_Free(APP_BLE_EvtBlock_T *p_block)
+{
+    OSAL_POOL_Put(&s_evtPool, p_block);
+}
+
+const OSAL_POOL *APP_BLE_EvtPool_Get(void)
+{
+    return &s_evtPool;
+}
+
+/* *****************************************************************************
+ End of File
+ */
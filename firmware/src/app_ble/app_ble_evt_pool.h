@@ -0,0 +1,129 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Event Pool Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_evt_pool.h
+
+  Summary:
+    This header file provides the fixed block pools holding the BLE stack
+    events on their way to the application task.
+
+  Description:
+    The stack callback copies every event into a block taken from the
+    smallest size class that holds it, together with the CCCD list of a
+    GATTS_EVT_CLIENT_CCCDLIST_CHANGE event. Only the block pointer is queued.
+    The application task returns the block once the event is handled. When a
+    size class runs out the next larger one is used; when all are out the
+    event is dropped, as it was when the heap allocation failed.
+
+    The size classes form an OSAL pool without heap fallback, see
+    osal_pool.h. Blocks are static, allocation takes the head of a free list
+    under a short critical section, so its time does not depend on the
+    history and the heap does not fragment. The stack task allocates and the
+    application task frees.
+*******************************************************************************/
+
+#ifndef APP_BLE_EVT_POOL_H
+#define APP_BLE_EVT_POOL_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "stack_mgr.h"
+#include "osal_pool.h"
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+/**@brief Small events, connection and security state changes. */
+#define APP_BLE_EVT_POOL_SMALL_SIZE     (64U)
+#define APP_BLE_EVT_POOL_SMALL_COUNT    (16U)
+
+/**@brief GAP and GATT events up to a full MTU of data, advertising reports. */
+#define APP_BLE_EVT_POOL_MEDIUM_SIZE    (272U)
+#define APP_BLE_EVT_POOL_MEDIUM_COUNT   (12U)
+
+/**@brief L2CAP events carrying a whole SDU. */
+#define APP_BLE_EVT_POOL_LARGE_SIZE     (1040U)
+#define APP_BLE_EVT_POOL_LARGE_COUNT    (3U)
+
+/**@brief Number of size classes. */
+#define APP_BLE_EVT_POOL_CLASSES        (3U)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+/**@brief One queued stack event. */
+typedef struct APP_BLE_EvtBlock_T
+{
+    STACK_Event_T               stackEvt;                                   /**< Event header, p_event points to data. */
+    uint32_t                    traceStamp;                                 /**< Receive stamp of a traced write, 0 if not traced. See motor_latency.h. */
+    uint32_t                    data[];                                     /**< Event copy followed by its CCCD list, word aligned. */
+} APP_BLE_EvtBlock_T;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+void APP_BLE_EvtPool_Init(void);
+APP_BLE_EvtBlock_T *APP_BLE_EvtPool_Alloc(uint16_t dataLen);
+void APP_BLE_EvtPool_Free(APP_BLE_EvtBlock_T *p_block);
+const OSAL_POOL *APP_BLE_EvtPool_Get(void);
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif /* APP_BLE_EVT_POOL_H */
+
+/*******************************************************************************
+ End of File
+ */
@@ -49,9 +49,18 @@
 #include "configuration.h"
 #include "system/console/sys_console.h"
 #include "osal/osal_freertos_extend.h"
+#include "osal_pool.h"
+#include "app.h"
 #include "app_ble.h"
 #include "app_ble_handler.h"
+#include "app_ble_bulk.h"
+#include "app_ble_evt_pool.h"
+#include "app_ble_peri_adv.h"
+#include "app_ble_ad_filter.h"
+#include "motor_control.h"
+#include "motor_proto.h"
 #include "ble_cms/ble_ctrl_svc.h"
+#include "svc_client.h"
 #include "peripheral/tcc/plib_tcc1.h"
 
 // *****************************************************************************
@@ -62,15 +71,7 @@
 
 #define APP_BLE_NUM_ADDR_IN_DEV_NAME    2    /**< The number of bytes of device address included in the device name. */
 
-
-
-// BLE Advertising Data Types
-#define AD_TYPE_FLAGS              0x01
-#define AD_TYPE_COMPLETE_NAME      0x09
-#define AD_TYPE_SHORT_NAME         0x08
-#define AD_TYPE_MANUFACTURER_DATA  0xFF
-#define AD_TYPE_UUID16_COMPLETE    0x03
-#define AD_TYPE_UUID128_COMPLETE   0x07
+#define APP_BLE_REMOTE_UUID16           0xCD01    /**< Service UUID advertised by the door remote. */
 
 
 // *****************************************************************************
@@ -92,126 +93,69 @@ static APP_BLE_ConnList_T       s_bleConnList[APP_BLE_MAX_LINK_NUMBER];
 static APP_BLE_ConnList_T       *sp_currentBleLink = NULL; /**< This pointer means the last one connected BLE link. */
 static uint8_t                  s_currBleConnIdx;
 
-// Function to parse BLE advertising data
-void parse_ble_adv_data(uint8_t *data, uint8_t len) {
-    uint8_t index = 0;
-    //SYS_CONSOLE_HANDLE myConsoleHandle;
-    //myConsoleHandle = SYS_CONSOLE_HandleGet(SYS_CONSOLE_INDEX_0);
+// Door remote with correct service (Use specific name for demo purposes)
+static const uint16_t           s_remoteUuid16[] = { APP_BLE_REMOTE_UUID16 };
+static const APP_BLE_AdFilter_T s_remoteFilter =
+{
+    .require = APP_BLE_AD_MATCH_UUID16 | APP_BLE_AD_MATCH_NAME,
+    APP_BLE_AD_FILTER_UUID16(s_remoteUuid16),
+    APP_BLE_AD_FILTER_NAME("door_remote"),
+};
 
-    while (index < len) {
-        uint8_t field_len = data[index]; // First byte is length
-        if (field_len == 0 || index + field_len >= len) {
-            break; // Stop if length is invalid
-        }
+// *****************************************************************************
+// *****************************************************************************
+// Section: Global Variables
+// *****************************************************************************
+// *****************************************************************************
 
-        uint8_t field_type = data[index + 1]; // Second byte is type
-        uint8_t *field_value = &data[index + 2]; // Value starts after length and type
 
-        ////SYS_CONSOLE_PRINT("Type: 0x%02X, Length: %d, Data: ", field_type, field_len - 1);
+#if APP_BLE_STATS_PRINT
+/* Block occupancy of one pool, per size class */
+static void APP_PoolPrint(const char *p_name, const OSAL_POOL *p_pool)
+{
+    const OSAL_POOL_STATS *p_stats;
+    uint8_t i;
 
-        switch (field_type) {
-            case AD_TYPE_COMPLETE_NAME:
-            case AD_TYPE_SHORT_NAME:
-                //SYS_CONSOLE_MESSAGE("Device Name: ");
-                for (int i = 0; i <field_len-1; i++)
-                {
-                    //SYS_CONSOLE_Print(myConsoleHandle, "%c", *field_value);
-                    field_value+=1;
-                }
-                //SYS_CONSOLE_MESSAGE("\r\n");
-                break;
-            case AD_TYPE_UUID16_COMPLETE:
-                //SYS_CONSOLE_PRINT("UUID16: 0x%02X%02X\r\n", field_value[1], field_value[0]);
-                break;
-            case AD_TYPE_UUID128_COMPLETE:
-                ////SYS_CONSOLE_MESSAGE("UUID128: ");
-                //for (int i = field_len - 2; i >= 0; i--) {
-                //    //SYS_CONSOLE_PRINT("%02X", field_value[i]);
-                //}
-                break;
-            case AD_TYPE_MANUFACTURER_DATA:
-                ////SYS_CONSOLE_MESSAGE("Manufacturer Data: ");
-                //for (int i = 0; i < field_len - 1; i++) {
-                //    //SYS_CONSOLE_PRINT("%02X ", field_value[i]);
-                //}
-                break;
-            default:
-                ////SYS_CONSOLE_MESSAGE("Unknown");
-                break;
-        }
-        index += field_len + 1; // Move to the next field
+    for (i = 0; i < p_pool->numClasses; i++)
+    {
+        p_stats = &p_pool->pClasses[i].stats;
+        SYS_CONSOLE_PRINT("%s pool %u B in use %u/%u high %u allocs %lu spills %lu fails %lu\r\n",
+            p_name, p_stats->blockSize, p_stats->inUse, p_stats->blocks, p_stats->highWater,
+            (unsigned long)p_stats->allocs, (unsigned long)p_stats->spills, (unsigned long)p_stats->fails);
     }
-}
-
-
-// Function to parse BLE advertising data
-uint16_t parse_UUID16(uint8_t *data, uint8_t len) {
-    uint8_t index = 0;
-    uint16_t uuid = 0;
-
-    while (index < len) {
-        uint8_t field_len = data[index]; // First byte is length
-        if (field_len == 0 || index + field_len >= len) {
-            break; // Stop if length is invalid
-        }
-
-        uint8_t field_type = data[index + 1]; // Second byte is type
-        uint8_t *field_value = &data[index + 2]; // Value starts after length and type
-
-        ////SYS_CONSOLE_PRINT("Type: 0x%02X, Length: %d, Data: ", field_type, field_len - 1);
-
-        switch (field_type) {
-            case AD_TYPE_UUID16_COMPLETE:
-                uuid = (field_value[1] << 8) + field_value[0];
-                return uuid;
-            default:
-                ////SYS_CONSOLE_MESSAGE("Unknown field type in scan data \r\n");
-                break;
-        }
-        index += field_len + 1; // Move to the next field
+    if (p_pool->heapFallback)
+    {
+        SYS_CONSOLE_PRINT("%s pool heap fallbacks %lu\r\n", p_name, (unsigned long)p_pool->heapFallbacks);
     }
-    return uuid;
 }
 
-// Function to parse BLE advertising data
-bool check_local_name(uint8_t *data, uint8_t len, const char* pName) {
-    uint8_t index = 0;
-
-    while (index < len) {
-        uint8_t field_len = data[index]; // First byte is length
-        if (field_len == 0 || index + field_len >= len) {
-            break; // Stop if length is invalid
+/* Command latency histograms, bin n counts from 2^(n+3) us */
+static void APP_LatencyPrint(void)
+{
+    static const char * const s_segmentNames[MOTOR_LAT_SEGMENTS] = { "queue", "dispatch", "actuate", "ble", "button" };
+    const motorLatStats_t *p_stats = Motor_Latency_GetStats();
+    const motorLatHistogram_t *p_hist;
+    uint32_t i, j;
+
+    SYS_CONSOLE_PRINT("Latency overruns %lu unactuated %lu\r\n",
+        (unsigned long)p_stats->overruns, (unsigned long)p_stats->unactuated);
+    for (i = 0; i < (uint32_t)MOTOR_LAT_SEGMENTS; i++)
+    {
+        p_hist = &p_stats->segment[i];
+        if (p_hist->count == 0U)
+        {
+            continue;
         }
-
-        uint8_t field_type = data[index + 1]; // Second byte is type
-        uint8_t *field_value = &data[index + 2]; // Value starts after length and type
-
-        ////SYS_CONSOLE_PRINT("Type: 0x%02X, Length: %d, Data: ", field_type, field_len - 1);
-
-        switch (field_type) {
-            case AD_TYPE_COMPLETE_NAME:
-            case AD_TYPE_SHORT_NAME:
-                //SYS_CONSOLE_MESSAGE("Device Name: ");
-                if (strncmp((const char *)field_value, pName, strlen(pName)) == 0)
-                    return true;
-                //SYS_CONSOLE_MESSAGE("\r\n");
-                break;
-            default:
-                ////SYS_CONSOLE_MESSAGE("Unknown field type in scan data \r\n");
-                break;
+        SYS_CONSOLE_PRINT("Latency %s n %lu mean %lu us max %lu us:", s_segmentNames[i], (unsigned long)p_hist->count,
+            (unsigned long)(p_hist->sumUs / p_hist->count), (unsigned long)p_hist->maxUs);
+        for (j = 0; j < MOTOR_LAT_BINS; j++)
+        {
+            SYS_CONSOLE_PRINT(" %lu", (unsigned long)p_hist->bins[j]);
         }
-        index += field_len + 1; // Move to the next field
+        SYS_CONSOLE_MESSAGE("\r\n");
     }
-    return false;
 }
-
-
-// *****************************************************************************
-// *****************************************************************************
-// Section: Global Variables
-// *****************************************************************************
-// *****************************************************************************
-
+#endif
 
 // *****************************************************************************
 // *****************************************************************************
@@ -327,7 +271,6 @@ uint16_t APP_GetConnHandleByIndex(uint8_t index)
 
     return 0xFFFF;
 }
-bool notificationsEnabled = false;
 
 uint16_t APP_StartAdvertising()
 {
@@ -336,7 +279,11 @@ uint16_t APP_StartAdvertising()
         return 0xFFFF;
 
     // Start Advertisement
+#if APP_BLE_PERI_ADV_EXTENDED
+    uint16_t result = APP_BLE_PeriAdv_StartConnectable();
+#else
     uint16_t result = BLE_GAP_SetAdvEnable(true, 0);
+#endif
 
     if (result == MBA_RES_SUCCESS)
     {
@@ -344,6 +291,78 @@ uint16_t APP_StartAdvertising()
     }
     return MBA_RES_SUCCESS;
 }
+
+/* Peripheral links whose peer turned on notifications of the control characteristic */
+static bool APP_BLE_NtfSubscribed(const APP_BLE_ConnList_T *p_bleConn)
+{
+    return ((p_bleConn->linkState >= APP_BLE_STATE_CONNECTED) &&
+            (p_bleConn->connData.role == BLE_GAP_ROLE_PERIPHERAL) &&
+            ((p_bleConn->ctrlCccd & NOTIFICATION) != 0U));
+}
+
+static void APP_BLE_NtfParamsSet(GATTS_HandleValueParams_T *p_hvParams, uint16_t charHandle, const uint8_t *p_data, uint16_t len)
+{
+    p_hvParams->charHandle = charHandle;
+    p_hvParams->charLength = len;
+    memcpy(p_hvParams->charValue, p_data, len);
+    p_hvParams->sendType = ATT_HANDLE_VALUE_NTF;
+}
+
+/* Sends queued frames in order until the link runs out of transmit buffers again */
+static void APP_BLE_NtfRetry(APP_BLE_ConnList_T *p_bleConn)
+{
+    APP_BLE_NtfQueue_T *p_queue = &p_bleConn->ntfQueue;
+    APP_BLE_NtfFrame_T *p_frame;
+    GATTS_HandleValueParams_T  hvParams;
+    uint16_t result;
+
+    if (!APP_BLE_NtfSubscribed(p_bleConn))
+    {
+        APP_BLE_NtfQueue_Flush(p_queue);
+        return;
+    }
+    while ((p_frame = APP_BLE_NtfQueue_Peek(p_queue)) != NULL)
+    {
+        APP_BLE_NtfParamsSet(&hvParams, p_frame->charHandle, p_frame->data, p_frame->len);
+        result = GATTS_SendHandleValue(p_bleConn->connData.handle, &hvParams);
+        if ((result == MBA_RES_NO_RESOURCE) || (result == MBA_RES_OOM))
+        {
+            // wait for the next BLE_GAP_EVT_TX_BUF_AVAILABLE
+            break;
+        }
+        if (result == MBA_RES_SUCCESS)
+        {
+            p_queue->stats.sent++;
+        }
+        else
+        {
+            p_queue->stats.dropped++;
+        }
+        APP_BLE_NtfQueue_Pop(p_queue);
+    }
+}
+
+/* Connects to the door remote found by the legacy or the extended scan */
+static void APP_RemoteConnect(const BLE_GAP_Addr_T *p_addr)
+{
+    BLE_GAP_CreateConnParams_T createConnParam_t;
+    createConnParam_t.scanInterval = 0x3C; // 37.5 ms
+    createConnParam_t.scanWindow = 0x1E; // 18.75 ms
+    createConnParam_t.filterPolicy = BLE_GAP_SCAN_FP_ACCEPT_ALL;
+    createConnParam_t.peerAddr.addrType = p_addr->addrType;
+    memcpy(createConnParam_t.peerAddr.addr, p_addr->addr, GAP_MAX_BD_ADDRESS_LEN);
+    createConnParam_t.connParams.intervalMin = 6; // 6 = max 7.5ms
+    createConnParam_t.connParams.intervalMax = 6;
+    createConnParam_t.connParams.latency = 0;
+    createConnParam_t.connParams.supervisionTimeout = 0x48;
+    //SYS_CONSOLE_MESSAGE("Initiating Connection\r\n");
+#if APP_BLE_PERI_ADV_EXTENDED
+    APP_BLE_PeriAdv_Connect(&createConnParam_t);
+#else
+    BLE_GAP_CreateConnection(&createConnParam_t);
+#endif
+}
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Functions
@@ -362,7 +381,6 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
             else
             {
                 p_bleConn = APP_GetBleLinkByStates(APP_BLE_STATE_ADVERTISING, APP_BLE_STATE_ADVERTISING);
-                notificationsEnabled = false;
             }
             
             if (p_bleConn)
@@ -376,6 +394,10 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
                 p_bleConn->connData.connInterval            = p_event->eventField.evtConnect.interval;
                 p_bleConn->connData.connLatency             = p_event->eventField.evtConnect.latency;
                 p_bleConn->connData.supervisionTimeout      = p_event->eventField.evtConnect.supervisionTimeout;
+                p_bleConn->connData.attMtu                  = BLE_ATT_DEFAULT_MTU_LEN;
+                p_bleConn->ctrlCccd                         = 0;
+                p_bleConn->connData.txPhy                   = BLE_GAP_PHY_TYPE_LE_1M;
+                p_bleConn->connData.rxPhy                   = BLE_GAP_PHY_TYPE_LE_1M;
 
                 /* Save Remote Device Address */
                 p_bleConn->connData.remoteAddr.addrType = p_event->eventField.evtConnect.remoteAddr.addrType;
@@ -385,6 +407,23 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
                 memcpy((uint8_t *)p_bleConn->secuData.smpInitiator.addr, (uint8_t *)p_event->eventField.evtConnect.remoteAddr.addr, GAP_MAX_BD_ADDRESS_LEN);
 
                 sp_currentBleLink = p_bleConn;
+
+                if (p_bleConn->connData.role == BLE_GAP_ROLE_PERIPHERAL)
+                {
+                    /* The control link carries the telemetry stream, ask the phone for
+                     * the largest MTU and the 2M PHY straight away instead of waiting
+                     * for it to start either procedure. The results are recorded by
+                     * ATT_EVT_UPDATE_MTU and BLE_GAP_EVT_PHY_UPDATE. */
+                    if (GATTC_ExchangeMTURequest(p_bleConn->connData.handle, BLE_ATT_MAX_MTU_LEN) != MBA_RES_SUCCESS)
+                    {
+                        SYS_CONSOLE_MESSAGE("MTU exchange request failed\r\n");
+                    }
+                    if (BLE_GAP_SetPhy(p_bleConn->connData.handle, BLE_GAP_PHY_OPTION_2M, BLE_GAP_PHY_OPTION_2M, BLE_GAP_PHY_PREF_NO) != MBA_RES_SUCCESS)
+                    {
+                        SYS_CONSOLE_MESSAGE("PHY update request failed\r\n");
+                    }
+                    APP_BLE_ConnPolicy_Init(&p_bleConn->connPolicy, p_bleConn->connData.connInterval);
+                }
             }
         }
         break;
@@ -392,14 +431,33 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
         case BLE_GAP_EVT_DISCONNECTED:
         {
             APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.evtDisconnect.connHandle);
-            if (p_bleConn->connData.role == BLE_GAP_ROLE_PERIPHERAL)
+            SYS_CONSOLE_PRINT("Connection handle %d\r\n", p_event->eventField.evtDisconnect.connHandle);
+            if (p_bleConn != NULL)
             {
-                notificationsEnabled = false;
-                ////SYS_CONSOLE_MESSAGE("Restarting advertising\r\n");
-                // Restart Advertisement when peripheral disconnected
-                APP_StartAdvertising();
+                if (p_bleConn->connData.role == BLE_GAP_ROLE_PERIPHERAL)
+                {
+                    ////SYS_CONSOLE_MESSAGE("Restarting advertising\r\n");
+                    // Restart Advertisement when peripheral disconnected
+                    APP_StartAdvertising();
+                }
+#if APP_BLE_STATS_PRINT
+                APP_BLE_NtfStats_T *p_stats = &p_bleConn->ntfQueue.stats;
+                SYS_CONSOLE_PRINT("Notifications sent %lu queued %lu coalesced %lu dropped %lu refused %lu\r\n",
+                    (unsigned long)p_stats->sent, (unsigned long)p_stats->queued, (unsigned long)p_stats->coalesced,
+                    (unsigned long)(p_stats->dropped + p_bleConn->ntfQueue.count), (unsigned long)p_stats->refused);
+                SYS_CONSOLE_PRINT("Write commands received %lu lost %lu, fixed layout dropped %lu\r\n",
+                    (unsigned long)p_bleConn->cmdSeq.received, (unsigned long)p_bleConn->cmdSeq.lost,
+                    (unsigned long)p_bleConn->legacyDropped);
+                SYS_CONSOLE_PRINT("Conn updates requested %lu accepted %lu failed %lu changed %lu, fast %lu s idle %lu s\r\n",
+                    (unsigned long)p_bleConn->connPolicy.stats.requests, (unsigned long)p_bleConn->connPolicy.stats.accepted,
+                    (unsigned long)p_bleConn->connPolicy.stats.failed, (unsigned long)p_bleConn->connPolicy.stats.updates,
+                    (unsigned long)p_bleConn->connPolicy.stats.fastSeconds, (unsigned long)p_bleConn->connPolicy.stats.idleSeconds);
+                APP_LatencyPrint();
+                APP_PoolPrint("Event", APP_BLE_EvtPool_Get());
+                APP_PoolPrint("OSAL", OSAL_POOL_GetMiddleware());
+#endif
             }
-            SYS_CONSOLE_PRINT("Connection handle %d\r\n", p_event->eventField.evtDisconnect.connHandle);
+            APP_BLE_Bulk_Disconnected(p_event->eventField.evtDisconnect.connHandle);
             // Clear connection list
             APP_ClearConnListByConnHandle(p_event->eventField.evtDisconnect.connHandle);
 
@@ -412,7 +470,20 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
 
         case BLE_GAP_EVT_CONN_PARAM_UPDATE:
         {
-            /* TODO: implement your application code.*/
+            APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.evtConnParamUpdate.connHandle);
+
+            if ((p_bleConn != NULL) && (p_event->eventField.evtConnParamUpdate.status == GAP_STATUS_SUCCESS))
+            {
+                p_bleConn->connData.connInterval        = p_event->eventField.evtConnParamUpdate.connParam.intervalMin;
+                p_bleConn->connData.connLatency         = p_event->eventField.evtConnParamUpdate.connParam.latency;
+                p_bleConn->connData.supervisionTimeout  = p_event->eventField.evtConnParamUpdate.connParam.supervisionTimeout;
+                if (p_bleConn->connData.role == BLE_GAP_ROLE_PERIPHERAL)
+                {
+                    APP_BLE_ConnPolicy_Updated(&p_bleConn->connPolicy, p_bleConn->connData.connInterval);
+                }
+                SYS_CONSOLE_PRINT("Conn interval %u latency %u\r\n",
+                    p_bleConn->connData.connInterval, p_bleConn->connData.connLatency);
+            }
         }
         break;
 
@@ -424,26 +495,11 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
 
         case BLE_GAP_EVT_ADV_REPORT:
         {
-            uint16_t UUID = parse_UUID16(p_event->eventField.evtAdvReport.advData, p_event->eventField.evtAdvReport.length);
-            // door remote with correct service (Use specific name for demo purposes)?
-            if (UUID == 0xCD01 && check_local_name(p_event->eventField.evtAdvReport.advData, p_event->eventField.evtAdvReport.length, "door_remote") )
+            if (APP_BLE_AdFilter_IsMatch(&s_remoteFilter, p_event->eventField.evtAdvReport.advData, p_event->eventField.evtAdvReport.length))
             {
                 //SYS_CONSOLE_MESSAGE("Found Peer Node\r\n");
-                BLE_GAP_CreateConnParams_T createConnParam_t;
-                createConnParam_t.scanInterval = 0x3C; // 37.5 ms
-                createConnParam_t.scanWindow = 0x1E; // 18.75 ms
-                createConnParam_t.filterPolicy = BLE_GAP_SCAN_FP_ACCEPT_ALL;
-                createConnParam_t.peerAddr.addrType = p_event->eventField.evtAdvReport.addr.addrType;
-                memcpy(createConnParam_t.peerAddr.addr, p_event->eventField.evtAdvReport.addr.addr, GAP_MAX_BD_ADDRESS_LEN);
-                createConnParam_t.connParams.intervalMin = 6; // 6 = max 7.5ms
-                createConnParam_t.connParams.intervalMax = 6;
-                createConnParam_t.connParams.latency = 0;
-                createConnParam_t.connParams.supervisionTimeout = 0x48;
-                //SYS_CONSOLE_MESSAGE("Initiating Connection\r\n");
-                BLE_GAP_CreateConnection(&createConnParam_t);                
+                APP_RemoteConnect(&p_event->eventField.evtAdvReport.addr);
             }
-            ////SYS_CONSOLE_MESSAGE("ADV_REPORT\r\n");
-            //parse_ble_adv_data(p_event->eventField.evtAdvReport.advData, p_event->eventField.evtAdvReport.length);
         }
         break;
 
@@ -461,7 +517,16 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
 
         case BLE_GAP_EVT_EXT_ADV_REPORT:
         {
-            /* TODO: implement your application code.*/
+#if APP_BLE_PERI_ADV_EXTENDED
+            // the extended scan stands in for legacy scanning, the door remote uses legacy PDUs
+            if (((p_event->eventField.evtExtAdvReport.eventType & BLE_GAP_EXT_ADV_RPT_TYPE_LEGACY) != 0U) &&
+                ((p_event->eventField.evtExtAdvReport.eventType & BLE_GAP_EXT_ADV_RPT_TYPE_CONNECTABLE) != 0U) &&
+                APP_BLE_AdFilter_IsMatch(&s_remoteFilter, p_event->eventField.evtExtAdvReport.advData, p_event->eventField.evtExtAdvReport.length))
+            {
+                APP_RemoteConnect(&p_event->eventField.evtExtAdvReport.addr);
+            }
+            APP_BLE_PeriAdv_ExtAdvReport(&p_event->eventField.evtExtAdvReport);
+#endif
         }
         break;
 
@@ -473,7 +538,19 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
 
         case BLE_GAP_EVT_TX_BUF_AVAILABLE:
         {
-            /* TODO: implement your application code.*/
+            p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.evtTxBufAvailable.connHandle);
+            if (p_bleConn != NULL)
+            {
+                APP_BLE_NtfRetry(p_bleConn);
+            }
+            if (APP_BLE_Bulk_TxBufAvailable(p_event->eventField.evtTxBufAvailable.connHandle))
+            {
+                APP_Msg_T appMsg;
+
+                // the stream stalled on the bulk channel, drain it again
+                appMsg.msgId = APP_MSG_TELEMETRY;
+                OSAL_QUEUE_Send(&appData.appQueue, &appMsg, 0);
+            }
         }
         break;
 
@@ -491,7 +568,14 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
 
         case BLE_GAP_EVT_PHY_UPDATE:
         {
-            /* TODO: implement your application code.*/
+            p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.evtPhyUpdate.connHandle);
+            if ((p_bleConn != NULL) && (p_event->eventField.evtPhyUpdate.status == GAP_STATUS_SUCCESS))
+            {
+                p_bleConn->connData.txPhy = p_event->eventField.evtPhyUpdate.txPhy;
+                p_bleConn->connData.rxPhy = p_event->eventField.evtPhyUpdate.rxPhy;
+            }
+            SYS_CONSOLE_PRINT("PHY handle %d status %d tx %d rx %d\r\n", p_event->eventField.evtPhyUpdate.connHandle,
+                p_event->eventField.evtPhyUpdate.status, p_event->eventField.evtPhyUpdate.txPhy, p_event->eventField.evtPhyUpdate.rxPhy);
         }
         break;
 
@@ -509,19 +593,25 @@ void APP_BleGapEvtHandler(BLE_GAP_Event_T *p_event)
 
         case BLE_GAP_EVT_PERI_ADV_SYNC_EST:
         {
-            /* TODO: implement your application code.*/
+#if APP_BLE_PERI_ADV_EXTENDED
+            APP_BLE_PeriAdv_SyncEst(&p_event->eventField.evtPeriAdvSyncEst);
+#endif
         }
         break;
 
         case BLE_GAP_EVT_PERI_ADV_REPORT:
         {
-            /* TODO: implement your application code.*/
+#if APP_BLE_PERI_ADV_EXTENDED
+            APP_BLE_PeriAdv_Report(&p_event->eventField.evtPeriAdvReport);
+#endif
         }
         break;
 
         case BLE_GAP_EVT_PERI_ADV_SYNC_LOST:
         {
-            /* TODO: implement your application code.*/
+#if APP_BLE_PERI_ADV_EXTENDED
+            APP_BLE_PeriAdv_SyncLost(&p_event->eventField.evtPeriAdvSyncLost);
+#endif
         }
         break;
 
@@ -594,76 +684,308 @@ void APP_BleL2capEvtHandler(BLE_L2CAP_Event_T *p_event)
         break;
 
         case BLE_L2CAP_EVT_CB_CONN_IND:
+        case BLE_L2CAP_EVT_CB_CONN_FAIL_IND:
+        case BLE_L2CAP_EVT_CB_SDU_IND:
+        case BLE_L2CAP_EVT_CB_ADD_CREDITS_IND:
+        case BLE_L2CAP_EVT_CB_DISC_IND:
         {
-            /* TODO: implement your application code.*/
+            APP_BLE_Bulk_L2capEvtHandler(p_event);
         }
         break;
 
-        case BLE_L2CAP_EVT_CB_CONN_FAIL_IND:
+        default:
+        break;
+    }
+}
+
+extern uint16_t s_ctrlChar1ValLen;
+
+uint16_t APP_GetNotificationMaxLen(void)
+{
+    uint16_t maxLen = 0;
+    uint16_t linkLen;
+    uint8_t i;
+
+    // a shared notification has to fit the smallest MTU of all subscribers
+    for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
+    {
+        if (APP_BLE_NtfSubscribed(&s_bleConnList[i]))
         {
-            /* TODO: implement your application code.*/
+            linkLen = s_bleConnList[i].connData.attMtu - ATT_HANDLE_VALUE_HEADER_SIZE;
+            if ((maxLen == 0U) || (linkLen < maxLen))
+            {
+                maxLen = linkLen;
+            }
         }
-        break;
+    }
+    return (maxLen > s_ctrlChar1ValLen) ? s_ctrlChar1ValLen : maxLen;
+}
 
-        case BLE_L2CAP_EVT_CB_SDU_IND:
+/* Sends one notification on a link once its queued frames are out, queues it otherwise */
+static bool APP_BLE_NtfLinkSend(APP_BLE_ConnList_T *p_bleConn, GATTS_HandleValueParams_T *p_hvParams, APP_BLE_NtfPolicy_T policy)
+{
+    uint16_t result;
+
+    if (p_bleConn->ntfQueue.count == 0U)
+    {
+        result = GATTS_SendHandleValue(p_bleConn->connData.handle, p_hvParams);
+        if (result == MBA_RES_SUCCESS)
         {
-            /* TODO: implement your application code.*/
+            p_bleConn->ntfQueue.stats.sent++;
+            return true;
         }
-        break;
+        if ((result != MBA_RES_NO_RESOURCE) && (result != MBA_RES_OOM))
+        {
+            ////SYS_CONSOLE_PRINT("Send error on handle %d %d\r\n",p_bleConn->connData.handle, result);
+            return false;
+        }
+    }
+    return APP_BLE_NtfQueue_Put(&p_bleConn->ntfQueue, p_hvParams->charHandle, p_hvParams->charValue, p_hvParams->charLength, policy);
+}
 
-        case BLE_L2CAP_EVT_CB_ADD_CREDITS_IND:
+bool sendNotificationMessage(const char* buffer, uint32_t len, APP_BLE_NtfPolicy_T policy)
+{
+    GATTS_HandleValueParams_T  hvParams;
+    APP_BLE_ConnList_T *p_bleConn;
+    bool delivered = false;
+    uint8_t i;
+
+    // limit to size of characteristic
+    if (len > s_ctrlChar1ValLen) len = s_ctrlChar1ValLen;
+
+    // frames already waiting go first so every peer sees them in order
+    for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
+    {
+        p_bleConn = &s_bleConnList[i];
+        if (!APP_BLE_NtfSubscribed(p_bleConn))
         {
-            /* TODO: implement your application code.*/
+            continue;
         }
-        break;
+        APP_BLE_NtfRetry(p_bleConn);
+        if ((policy == APP_BLE_NTF_KEEP) && (p_bleConn->ntfQueue.count == APP_BLE_NTF_QUEUE_DEPTH))
+        {
+            // the caller keeps the frame, so either every subscriber gets it or none does
+            p_bleConn->ntfQueue.stats.refused++;
+            return false;
+        }
+    }
 
-        case BLE_L2CAP_EVT_CB_DISC_IND:
+    // the payload is copied into the stack parameters once and shared by all links
+    APP_BLE_NtfParamsSet(&hvParams, (uint16_t)CTRL_HDL_CHARVAL_1, (const uint8_t *)buffer, (uint16_t)len);
+    for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
+    {
+        p_bleConn = &s_bleConnList[i];
+        if (!APP_BLE_NtfSubscribed(p_bleConn))
         {
-            /* TODO: implement your application code.*/
+            continue;
         }
-        break;
+        if (APP_BLE_NtfLinkSend(p_bleConn, &hvParams, policy))
+        {
+            delivered = true;
+        }
+    }
+    return delivered;
+}
 
-        default:
-        break;
+/* Called once a second from the application task, active is true while the
+ * motor runs or the telemetry stream is on */
+void APP_ConnPolicyTick(bool active)
+{
+    APP_BLE_ConnList_T *p_bleConn;
+    uint8_t i;
+
+    for (i = 0; i < APP_BLE_MAX_LINK_NUMBER; i++)
+    {
+        p_bleConn = &s_bleConnList[i];
+        if ((p_bleConn->linkState >= APP_BLE_STATE_CONNECTED) && (p_bleConn->connData.role == BLE_GAP_ROLE_PERIPHERAL))
+        {
+            APP_BLE_ConnPolicy_Tick(&p_bleConn->connPolicy, p_bleConn->connData.handle, active);
+        }
     }
 }
 
-extern void Motor_Start();
-extern void Motor_Stop();
-extern void Motor_Toggle();
-extern void Motor_SetSpeed(uint8_t percentage);
-extern uint16_t s_ctrlChar1ValLen;
+static motorProtoStatus_t APP_CmdRun(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    bool posted;
+
+    (void)len; (void)p_reply; (void)p_replyLen;
+    switch (p_value[0])
+    {
+        case 0: posted = Motor_Stop(); break;
+        case 1: posted = Motor_Start(); break;
+        case 2: posted = Motor_Toggle(); break;
+        default: return MOTOR_PROTO_BAD_VALUE;
+    }
+    return posted ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
 
-void sendNotificationMessage(const char* buffer, uint32_t len)
+static motorProtoStatus_t APP_CmdSpeed(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
 {
-    if (!notificationsEnabled)
+    (void)len; (void)p_reply; (void)p_replyLen;
+    if (p_value[0] > 100U)
     {
-        return;
+        return MOTOR_PROTO_BAD_VALUE;
     }
-    APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoForPeripheral();
-    if (p_bleConn == NULL)
+    return Motor_SetSpeed(p_value[0]) ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdDuty(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    uint32_t duty = Motor_Proto_GetU32(p_value, len);
+
+    (void)p_reply; (void)p_replyLen;
+    // a 16 bit value cannot hold 100 %, 0xFFFF stands for it as in the fixed layout
+    if ((len == 2U) && (duty == 0xFFFFU)) duty = 0x10000U;
+    if (duty > 0x10000U)
     {
-        //SYS_CONSOLE_MESSAGE("Peripheral not found\r\n");
-        return;
+        return MOTOR_PROTO_BAD_VALUE;
     }
-    
-    // limit to size of characteristic
-    if (len > s_ctrlChar1ValLen) len = s_ctrlChar1ValLen;
+    return Motor_SetDutyQ16(duty) ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdDither(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)len; (void)p_reply; (void)p_replyLen;
+    return Motor_SetDutyDither(p_value[0] != 0U) ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdMoveTo(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)p_reply; (void)p_replyLen;
+    return Motor_MoveTo(Motor_Proto_GetI32(p_value, len)) ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdMoveBy(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)p_reply; (void)p_replyLen;
+    return Motor_MoveBy(Motor_Proto_GetI32(p_value, len)) ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdSetPosition(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)p_reply; (void)p_replyLen;
+    // only while the motor is off
+    return Motor_SetPosition(Motor_Proto_GetI32(p_value, len)) ? MOTOR_PROTO_OK : MOTOR_PROTO_REJECTED;
+}
+
+static motorProtoStatus_t APP_CmdStream(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    uint8_t fields = p_value[1];
+
+    (void)len; (void)p_reply; (void)p_replyLen;
+    if (fields == 0U) fields = MOTOR_TLM_FIELD_ALL;
+    if ((fields & (uint8_t)~MOTOR_TLM_FIELD_ALL) != 0U)
+    {
+        return MOTOR_PROTO_BAD_VALUE;
+    }
+    return Motor_SetTelemetryStream(p_value[0], fields) ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdSpeedRpm(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)p_reply; (void)p_replyLen;
+    return Motor_SetSpeedRpm(Motor_Proto_GetU32(p_value, len)) ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdDirection(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)len; (void)p_reply; (void)p_replyLen;
+    if (p_value[0] > (uint8_t)MOTOR_REVERSE)
+    {
+        return MOTOR_PROTO_BAD_VALUE;
+    }
+    return Motor_SetDirection((motorDirection_t)p_value[0]) ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdProfile(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)len; (void)p_reply; (void)p_replyLen;
+    return Motor_SetMoveLimits(Motor_Proto_GetU32(&p_value[0], 4U), Motor_Proto_GetU32(&p_value[4], 4U)) ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdFaultClear(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)p_value; (void)len; (void)p_reply; (void)p_replyLen;
+    return Motor_FaultClear() ? MOTOR_PROTO_OK : MOTOR_PROTO_BUSY;
+}
+
+static motorProtoStatus_t APP_CmdQuery(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    motorTlmRecord_t record;
+
+    (void)p_value; (void)len;
+    memset(&record, 0, sizeof(record));
+    Motor_GetStatus(&record);
+    record.type = (uint8_t)MOTOR_TLM_SAMPLE;
+    record.timestamp = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    *p_replyLen = (uint8_t)Motor_Telemetry_Encode(&record, p_reply);
+    return MOTOR_PROTO_OK;
+}
+
+static motorProtoStatus_t APP_CmdLatency(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)len;
+    if (p_value[0] == MOTOR_PROTO_LATENCY_RESET)
+    {
+        Motor_Latency_Reset();
+        return MOTOR_PROTO_OK;
+    }
+    if (p_value[0] >= (uint8_t)MOTOR_LAT_SEGMENTS)
+    {
+        return MOTOR_PROTO_BAD_VALUE;
+    }
+    *p_replyLen = (uint8_t)Motor_Latency_Encode(p_value[0], p_reply);
+    return MOTOR_PROTO_OK;
+}
+
+static const motorProtoEntry_t s_ctrlCommands[] =
+{
+    { MOTOR_PROTO_CMD_RUN,          1, 1, APP_CmdRun },
+    { MOTOR_PROTO_CMD_SPEED,        1, 1, APP_CmdSpeed },
+    { MOTOR_PROTO_CMD_DUTY,         2, 4, APP_CmdDuty },
+    { MOTOR_PROTO_CMD_DITHER,       1, 1, APP_CmdDither },
+    { MOTOR_PROTO_CMD_MOVE_TO,      1, 4, APP_CmdMoveTo },
+    { MOTOR_PROTO_CMD_MOVE_BY,      1, 4, APP_CmdMoveBy },
+    { MOTOR_PROTO_CMD_SET_POSITION, 1, 4, APP_CmdSetPosition },
+    { MOTOR_PROTO_CMD_STREAM,       2, 2, APP_CmdStream },
+    { MOTOR_PROTO_CMD_SPEED_RPM,    1, 4, APP_CmdSpeedRpm },
+    { MOTOR_PROTO_CMD_DIRECTION,    1, 1, APP_CmdDirection },
+    { MOTOR_PROTO_CMD_PROFILE,      8, 8, APP_CmdProfile },
+    { MOTOR_PROTO_CMD_FAULT_CLEAR,  0, 0, APP_CmdFaultClear },
+    { MOTOR_PROTO_CMD_QUERY,        0, 0, APP_CmdQuery },
+    { MOTOR_PROTO_CMD_LATENCY,      1, 1, APP_CmdLatency },
+};
+
+/* Runs a TLV command frame and acknowledges it to the writer. Frames written
+ * without response are the setpoint fast path, they are only acknowledged when
+ * something went wrong, including commands lost on the way. */
+static void APP_CtrlCommandWrite(uint16_t connHandle, const uint8_t *p_frame, uint16_t len, bool withResponse)
+{
+    APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(connHandle);
     GATTS_HandleValueParams_T  hvParams;
+    motorProtoSeq_t *p_seq = NULL;
+    uint16_t ackMax = 0;
 
-    hvParams.charHandle = (uint16_t)CTRL_HDL_CHARVAL_1;
-    hvParams.charLength = len;
-    memcpy(hvParams.charValue, buffer, len);
-    hvParams.sendType = ATT_HANDLE_VALUE_NTF;
-    ////SYS_CONSOLE_PRINT("Sending notification on handle %d\r\n", p_bleConn->connData.handle);
-    uint16_t result = GATTS_SendHandleValue(p_bleConn->connData.handle, &hvParams);
-    if (result == MBA_RES_SUCCESS)
+    if ((p_bleConn != NULL) && !withResponse)
     {
-        ////SYS_CONSOLE_MESSAGE("message sent \r\n");
+        p_seq = &p_bleConn->cmdSeq;
     }
-    else
+
+    if ((p_bleConn != NULL) && APP_BLE_NtfSubscribed(p_bleConn))
+    {
+        ackMax = p_bleConn->connData.attMtu - ATT_HANDLE_VALUE_HEADER_SIZE;
+        if (ackMax > s_ctrlChar1ValLen) ackMax = s_ctrlChar1ValLen;
+    }
+    // the commands run even when nobody can receive the acknowledgement
+    hvParams.charLength = Motor_Proto_Process(s_ctrlCommands, (uint8_t)(sizeof(s_ctrlCommands) / sizeof(s_ctrlCommands[0])),
+                                              p_frame, len, p_seq, hvParams.charValue,
+                                              (ackMax == 0U) ? MOTOR_PROTO_ACK_HEADER_LEN : ackMax);
+    if ((ackMax != 0U) && (withResponse || Motor_Proto_AckFailed(hvParams.charValue, hvParams.charLength)))
     {
-        ////SYS_CONSOLE_PRINT("Send error on handle %d %d\r\n",p_bleConn->connData.handle, result);
+        hvParams.charHandle = (uint16_t)CTRL_HDL_CHARVAL_1;
+        hvParams.sendType = ATT_HANDLE_VALUE_NTF;
+        APP_BLE_NtfRetry(p_bleConn);
+        (void)APP_BLE_NtfLinkSend(p_bleConn, &hvParams, APP_BLE_NTF_DROP_OLDEST);
     }
 }
 
@@ -754,12 +1076,27 @@ void APP_GattEvtHandler(GATT_Event_T *p_event)
         {
             if (p_event->eventField.onWrite.attrHandle == CTRL_HDL_CHARVAL_0)
             {
+                APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.onWrite.connHandle);
+                bool posted = true;
+
+                Motor_Latency_Handled();
+                // any command means the phone is in control, switch to the short interval now
+                if ((p_bleConn != NULL) && (p_bleConn->connData.role == BLE_GAP_ROLE_PERIPHERAL))
+                {
+                    APP_BLE_ConnPolicy_Activity(&p_bleConn->connPolicy, p_bleConn->connData.handle);
+                }
                 ////SYS_CONSOLE_PRINT("GATTS_EVT_WRITE 0x%02x 0x%02x\r\n", p_event->eventField.onWrite.writeValue[2], p_event->eventField.onWrite.writeValue[3]);
-                if (p_event->eventField.onWrite.writeValue[2] == 0x10) // motor on/off
+                if (p_event->eventField.onWrite.writeDataLength != 4U) // TLV command frame, see motor_proto.h
+                {
+                    APP_CtrlCommandWrite(p_event->eventField.onWrite.connHandle,
+                                         p_event->eventField.onWrite.writeValue, p_event->eventField.onWrite.writeDataLength,
+                                         p_event->eventField.onWrite.writeType != ATT_WRITE_CMD);
+                }
+                else if (p_event->eventField.onWrite.writeValue[2] == 0x10) // motor on/off
                 {
                     if (p_event->eventField.onWrite.writeValue[3] == 1)
                     {
-                        Motor_Toggle();
+                        posted = Motor_Toggle();
                     }
                 }
                 else if (p_event->eventField.onWrite.writeValue[2] == 0x11) // motor speed
@@ -767,20 +1104,80 @@ void APP_GattEvtHandler(GATT_Event_T *p_event)
                     uint8_t speed = p_event->eventField.onWrite.writeValue[3];
                     // 0-100%
                     if (speed > 100) speed = 100;
-                    Motor_SetSpeed(speed);
+                    posted = Motor_SetSpeed(speed);
                 }
-                // send response
-                GATTS_SendWriteRespParams_T response;
-                response.attrHandle = p_event->eventField.onWrite.attrHandle;
-                response.responseType = ATT_WRITE_RSP;
-                if (GATTS_SendWriteResponse(p_event->eventField.onWrite.connHandle, &response) == MBA_RES_SUCCESS)
+                else if (p_event->eventField.onWrite.writeValue[2] == 0x12) // motor duty, fine
+                {
+                    // bytes 0-1: duty little endian, 0xFFFF = 100%
+                    uint32_t duty = (uint32_t)p_event->eventField.onWrite.writeValue[0]
+                                  | ((uint32_t)p_event->eventField.onWrite.writeValue[1] << 8);
+                    if (duty == 0xFFFFU) duty = 0x10000U;
+                    posted = Motor_SetDutyQ16(duty);
+                }
+                else if (p_event->eventField.onWrite.writeValue[2] == 0x13) // duty dithering on/off
                 {
+                    posted = Motor_SetDutyDither(p_event->eventField.onWrite.writeValue[3] != 0U);
+                }
+                else if ((p_event->eventField.onWrite.writeValue[2] >= 0x14) && (p_event->eventField.onWrite.writeValue[2] <= 0x16)) // position
+                {
+                    // bytes 0, 1 and 3: signed 24 bit position in QEI counts, little endian
+                    uint32_t raw = (uint32_t)p_event->eventField.onWrite.writeValue[0]
+                                 | ((uint32_t)p_event->eventField.onWrite.writeValue[1] << 8)
+                                 | ((uint32_t)p_event->eventField.onWrite.writeValue[3] << 16);
+                    int32_t position = (int32_t)(raw << 8) / 256;
+
+                    if (p_event->eventField.onWrite.writeValue[2] == 0x14) // absolute move
+                    {
+                        posted = Motor_MoveTo(position);
+                    }
+                    else if (p_event->eventField.onWrite.writeValue[2] == 0x15) // relative move
+                    {
+                        posted = Motor_MoveBy(position);
+                    }
+                    else // set current position, motor must be off
+                    {
+                        (void)Motor_SetPosition(position);
+                    }
+                }
+                else if (p_event->eventField.onWrite.writeValue[2] == 0x17) // telemetry stream
+                {
+                    // byte 3: control ticks per sample, 0 = off; byte 0: field mask, 0 = all
+                    uint8_t fields = p_event->eventField.onWrite.writeValue[0];
+                    if (fields == 0U) fields = MOTOR_TLM_FIELD_ALL;
+                    posted = Motor_SetTelemetryStream(p_event->eventField.onWrite.writeValue[3], fields);
+                }
+                if (!posted && (p_bleConn != NULL))
+                {
+                    // the fixed layout has no status, count it for the statistics
+                    p_bleConn->legacyDropped++;
+                }
+                // send response, a write command has none
+                if (p_event->eventField.onWrite.writeType == ATT_WRITE_REQ)
+                {
+                    GATTS_SendWriteRespParams_T response;
+                    response.attrHandle = p_event->eventField.onWrite.attrHandle;
+                    response.responseType = ATT_WRITE_RSP;
+                    if (GATTS_SendWriteResponse(p_event->eventField.onWrite.connHandle, &response) == MBA_RES_FAIL)
+                    {
+                        // no response is pending, the stack answered itself
+                        SYS_CONSOLE_MESSAGE("CTRL characteristic 0 needs Manual Write Response, check the Customized Service in MCC\r\n");
+                    }
                 }
             }
             else if (p_event->eventField.onWrite.attrHandle == CTRL_HDL_CCCD_1) // enable notifications
             {
                 ////SYS_CONSOLE_MESSAGE("GOT Notifications enable\r\n");
-                notificationsEnabled = true;
+                APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.onWrite.connHandle);
+                if ((p_bleConn != NULL) && (p_event->eventField.onWrite.writeDataLength >= 2U))
+                {
+                    // only this peer's subscription changes
+                    p_bleConn->ctrlCccd = (uint16_t)p_event->eventField.onWrite.writeValue[0] |
+                                          ((uint16_t)p_event->eventField.onWrite.writeValue[1] << 8);
+                    if ((p_bleConn->ctrlCccd & NOTIFICATION) == 0U)
+                    {
+                        APP_BLE_NtfQueue_Flush(&p_bleConn->ntfQueue);
+                    }
+                }
                 // send response
                 GATTS_SendWriteRespParams_T response;
                 response.attrHandle = p_event->eventField.onWrite.attrHandle;
@@ -807,7 +1204,12 @@ void APP_GattEvtHandler(GATT_Event_T *p_event)
 
         case ATT_EVT_UPDATE_MTU:
         {
-            /* TODO: implement your application code.*/
+            APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(p_event->eventField.onUpdateMTU.connHandle);
+            if (p_bleConn != NULL)
+            {
+                p_bleConn->connData.attMtu = p_event->eventField.onUpdateMTU.exchangedMTU;
+            }
+            SYS_CONSOLE_PRINT("MTU handle %d size %d\r\n", p_event->eventField.onUpdateMTU.connHandle, p_event->eventField.onUpdateMTU.exchangedMTU);
         }
         break;
 
@@ -832,7 +1234,6 @@ void APP_GattEvtHandler(GATT_Event_T *p_event)
         case GATTS_EVT_CLIENT_CCCDLIST_CHANGE:
         {
             /* TODO: implement your application code.*/
-            OSAL_Free(p_event->eventField.onClientCccdListChange.p_cccdList);
         }
         break;
 
@@ -941,7 +1342,11 @@ void APP_DmEvtHandler(BLE_DM_Event_T *p_event)
 
         case BLE_DM_EVT_CONNECTED:
         {
-            /* TODO: implement your application code.*/
+            /* BLE_DM runs ahead of BLE_DD for the same connection event. */
+            if (BLE_GDMC_PeerConnected(p_event->connHandle, p_event->peerDevId))
+            {
+                g_ddConfig.disableConnectedDisc = 1;
+            }
         }
         break;
 
@@ -971,19 +1376,19 @@ void APP_DmEvtHandler(BLE_DM_Event_T *p_event)
 
         case BLE_DM_EVT_PAIRED_DEVICE_UPDATED:
         {
-            /* TODO: implement your application code.*/
+            BLE_GDMC_PeerBonded(p_event->connHandle, p_event->peerDevId);
         }
         break;
 
         case BLE_DM_EVT_CONN_UPDATE_SUCCESS:
-        {
-            /* TODO: implement your application code.*/
-        }
-        break;
-
         case BLE_DM_EVT_CONN_UPDATE_FAIL:
         {
-            /* TODO: implement your application code.*/
+            APP_BLE_ConnList_T *p_bleConn = APP_GetConnInfoByConnHandle(p_event->connHandle);
+
+            if ((p_bleConn != NULL) && (p_bleConn->linkState >= APP_BLE_STATE_CONNECTED))
+            {
+                APP_BLE_ConnPolicy_Result(&p_bleConn->connPolicy, p_event->eventId == BLE_DM_EVT_CONN_UPDATE_SUCCESS);
+            }
         }
         break;
 
@@ -60,6 +60,9 @@
 #include "ble_dtm.h"
 #include "ble_dm/ble_dm.h"
 #include "ble_gcm/ble_dd.h"
+#include "app_ble_ntf.h"
+#include "app_ble_conn_policy.h"
+#include "motor_proto.h"
 
 
 // DOM-IGNORE-BEGIN
@@ -92,6 +95,12 @@ extern "C" {
 
 #define APP_BLE_UNKNOWN_ID              0xFF
 
+/**@brief Dump the link statistics, latency histograms and pool usage on every disconnect.
+ * Debug builds only, the door remote disconnects after each button press. */
+#ifndef APP_BLE_STATS_PRINT
+#define APP_BLE_STATS_PRINT             0
+#endif
+
 // *****************************************************************************
 // *****************************************************************************
 // Section: Type Definitions
@@ -122,6 +131,7 @@ typedef struct APP_BLE_ConnData_T
     uint16_t               supervisionTimeout;                             /**< Supervision timeout for the LE Link, see @ref BLE_GAP_CP_RANGE. */
     uint8_t                txPhy;                                          /**< TX PHY. See @ref BLE_GAP_PHY_TYPE. */
     uint8_t                rxPhy;                                          /**< RX PHY. See @ref BLE_GAP_PHY_TYPE. */
+    uint16_t               attMtu;                                         /**< ATT MTU agreed on this connection. */
 } APP_BLE_ConnData_T;
 
 /**@brief This structure contains the BLE security related information. */
@@ -139,6 +149,11 @@ typedef struct APP_BLE_ConnList_T
     APP_BLE_LinkState_T         linkState;                                              /**< BLE link state. see @ref APP_BLE_LinkState_T */
     APP_BLE_ConnData_T          connData;                                               /**< BLE connection information. See @ref APP_BLE_ConnData_T */
     APP_BLE_SecuData_T          secuData;                                               /**< BLE security information. See @ref APP_BLE_SecuData_T */
+    uint16_t                    ctrlCccd;                                               /**< CCCD of the control notify characteristic written by this peer. */
+    motorProtoSeq_t             cmdSeq;                                                 /**< Command numbering on the write without response path. See @ref motorProtoSeq_t */
+    uint32_t                    legacyDropped;                                          /**< Fixed layout commands the motor could not queue, they have no acknowledgement. */
+    APP_BLE_NtfQueue_T          ntfQueue;                                               /**< Notifications waiting for a transmit buffer. See @ref APP_BLE_NtfQueue_T */
+    APP_BLE_ConnPolicy_T        connPolicy;                                             /**< Connection parameter policy of the link. See @ref APP_BLE_ConnPolicy_T */
     //APP_BLE_TrcbpsConnData_T    trcbpsConnData[APP_BLE_L2CAP_MAX_LINK_NUM];             /**< BLE TRCBP connection parameters. See @ref APP_BLE_TrcbpsConnData_T */
 } APP_BLE_ConnList_T;
 
@@ -180,6 +195,9 @@ APP_BLE_ConnList_T *APP_GetLastOneConnectedBleLink(void);
 APP_BLE_ConnList_T *APP_GetBleLinkByStates(APP_BLE_LinkState_T start, APP_BLE_LinkState_T end);
 uint16_t APP_GetCurrentConnHandle(void);
 uint16_t APP_GetConnHandleByIndex(uint8_t index);
+uint16_t APP_GetNotificationMaxLen(void);
+bool sendNotificationMessage(const char* buffer, uint32_t len, APP_BLE_NtfPolicy_T policy);
+void APP_ConnPolicyTick(bool active);
 
 /*******************************************************************************
   Function:
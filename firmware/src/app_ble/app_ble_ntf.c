@@ -0,0 +1,138 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Notification Queue Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_ntf.c
+
+  Summary:
+    This file contains the bounded outbound notification queue.
+
+  Description:
+    This file contains the ring of frames waiting for a BLE transmit buffer
+    together with the full-queue policies. Sending is left to the caller.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "app_ble_ntf.h"
+
+
+static APP_BLE_NtfFrame_T *APP_BLE_NtfQueue_At(APP_BLE_NtfQueue_T *p_queue, uint8_t pos)
+{
+    return &p_queue->frame[(p_queue->head + pos) % APP_BLE_NTF_QUEUE_DEPTH];
+}
+
+void APP_BLE_NtfQueue_Init(APP_BLE_NtfQueue_T *p_queue)
+{
+    memset(p_queue, 0, sizeof(APP_BLE_NtfQueue_T));
+}
+
+bool APP_BLE_NtfQueue_Put(APP_BLE_NtfQueue_T *p_queue, uint16_t charHandle, const uint8_t *p_data, uint16_t len, APP_BLE_NtfPolicy_T policy)
+{
+    APP_BLE_NtfFrame_T *p_frame = NULL;
+    uint8_t i;
+
+    if (len > APP_BLE_NTF_FRAME_LEN)
+    {
+        len = APP_BLE_NTF_FRAME_LEN;
+    }
+
+    if (policy == APP_BLE_NTF_COALESCE)
+    {
+        // only the newest state matters, reuse the slot of the stale one
+        for (i = 0; i < p_queue->count; i++)
+        {
+            p_frame = APP_BLE_NtfQueue_At(p_queue, i);
+            if ((p_frame->policy == (uint8_t)APP_BLE_NTF_COALESCE) && (p_frame->charHandle == charHandle))
+            {
+                p_queue->stats.coalesced++;
+                break;
+            }
+            p_frame = NULL;
+        }
+    }
+
+    if (p_frame == NULL)
+    {
+        if (p_queue->count == APP_BLE_NTF_QUEUE_DEPTH)
+        {
+            if (policy == APP_BLE_NTF_KEEP)
+            {
+                p_queue->stats.refused++;
+                return false;
+            }
+            APP_BLE_NtfQueue_Pop(p_queue);
+            p_queue->stats.dropped++;
+        }
+        p_frame = APP_BLE_NtfQueue_At(p_queue, p_queue->count);
+        p_queue->count++;
+        p_queue->stats.queued++;
+    }
+
+    p_frame->charHandle = charHandle;
+    p_frame->len = len;
+    p_frame->policy = (uint8_t)policy;
+    memcpy(p_frame->data, p_data, len);
+    return true;
+}
+
+APP_BLE_NtfFrame_T *APP_BLE_NtfQueue_Peek(APP_BLE_NtfQueue_T *p_queue)
+{
+    if (p_queue->count == 0U)
+    {
+        return NULL;
+    }
+    return &p_queue->frame[p_queue->head];
+}
+
+void APP_BLE_NtfQueue_Pop(APP_BLE_NtfQueue_T *p_queue)
+{
+    if (p_queue->count != 0U)
+    {
+        p_queue->head = (uint8_t)((p_queue->head + 1U) % APP_BLE_NTF_QUEUE_DEPTH);
+        p_queue->count--;
+    }
+}
+
+void APP_BLE_NtfQueue_Flush(APP_BLE_NtfQueue_T *p_queue)
+{
+    p_queue->stats.dropped += p_queue->count;
+    p_queue->head = 0U;
+    p_queue->count = 0U;
+}
+
+/* *****************************************************************************
+ End of File
+ */
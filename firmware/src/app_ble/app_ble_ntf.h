@@ -0,0 +1,145 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Notification Queue Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_ntf.h
+
+  Summary:
+    This header file provides the bounded outbound notification queue kept
+    for every BLE connection.
+
+  Description:
+    GATTS_SendHandleValue fails with MBA_RES_NO_RESOURCE or MBA_RES_OOM while
+    the link has no free transmit buffer. Frames that cannot be sent right
+    away are parked in the queue of their connection and sent again when the
+    stack reports BLE_GAP_EVT_TX_BUF_AVAILABLE. The queue holds a few frames
+    only; what happens when it is full is chosen per frame by
+    APP_BLE_NtfPolicy_T.
+
+    The queue is not locked, it must only be used from the application task
+    that also handles the BLE stack events.
+*******************************************************************************/
+
+#ifndef APP_BLE_NTF_H
+#define APP_BLE_NTF_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gatt.h"
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+/**@brief Number of frames that can wait for a transmit buffer on one connection. */
+#define APP_BLE_NTF_QUEUE_DEPTH         (4U)
+
+/**@brief Largest notification payload, one full ATT MTU. */
+#define APP_BLE_NTF_FRAME_LEN           (BLE_ATT_MAX_MTU_LEN - ATT_HANDLE_VALUE_HEADER_SIZE)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+/**@brief What to do with a frame that has to be queued. */
+typedef enum APP_BLE_NtfPolicy_T
+{
+    APP_BLE_NTF_KEEP = 0,       /**< Queue if there is room, otherwise refuse it so the caller keeps the data. */
+    APP_BLE_NTF_DROP_OLDEST,    /**< Always queue, drop the oldest frame when the queue is full. */
+    APP_BLE_NTF_COALESCE        /**< Overwrite a queued frame that was also sent with this policy, otherwise as @ref APP_BLE_NTF_DROP_OLDEST. */
+} APP_BLE_NtfPolicy_T;
+
+/**@brief One queued notification. */
+typedef struct APP_BLE_NtfFrame_T
+{
+    uint16_t                charHandle;                                     /**< Attribute handle of the characteristic value. */
+    uint16_t                len;                                            /**< Payload length in bytes. */
+    uint8_t                 policy;                                         /**< Policy the frame was queued with. See @ref APP_BLE_NtfPolicy_T. */
+    uint8_t                 data[APP_BLE_NTF_FRAME_LEN];                    /**< Payload. */
+} APP_BLE_NtfFrame_T;
+
+/**@brief Notification counters of one connection. */
+typedef struct APP_BLE_NtfStats_T
+{
+    uint32_t                sent;                                           /**< Frames accepted by the stack. */
+    uint32_t                queued;                                         /**< Frames that had to wait for a transmit buffer. */
+    uint32_t                coalesced;                                      /**< Queued frames overwritten by a newer one. */
+    uint32_t                dropped;                                        /**< Queued frames discarded unsent. */
+    uint32_t                refused;                                        /**< Frames not taken because the queue was full. */
+} APP_BLE_NtfStats_T;
+
+/**@brief Bounded outbound notification queue of one connection. */
+typedef struct APP_BLE_NtfQueue_T
+{
+    APP_BLE_NtfFrame_T      frame[APP_BLE_NTF_QUEUE_DEPTH];                 /**< Frame storage, used as a ring. */
+    uint8_t                 head;                                           /**< Index of the oldest frame. */
+    uint8_t                 count;                                          /**< Number of queued frames. */
+    APP_BLE_NtfStats_T      stats;                                          /**< See @ref APP_BLE_NtfStats_T. */
+} APP_BLE_NtfQueue_T;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+void APP_BLE_NtfQueue_Init(APP_BLE_NtfQueue_T *p_queue);
+bool APP_BLE_NtfQueue_Put(APP_BLE_NtfQueue_T *p_queue, uint16_t charHandle, const uint8_t *p_data, uint16_t len, APP_BLE_NtfPolicy_T policy);
+APP_BLE_NtfFrame_T *APP_BLE_NtfQueue_Peek(APP_BLE_NtfQueue_T *p_queue);
+void APP_BLE_NtfQueue_Pop(APP_BLE_NtfQueue_T *p_queue);
+void APP_BLE_NtfQueue_Flush(APP_BLE_NtfQueue_T *p_queue);
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif /* APP_BLE_NTF_H */
+
+/*******************************************************************************
+ End of File
+ */
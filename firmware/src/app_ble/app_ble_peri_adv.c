@@ -0,0 +1,483 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Periodic Advertising Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_peri_adv.c
+
+  Summary:
+    This file contains the periodic advertising of the telemetry record and
+    the observer that synchronizes to other motors.
+
+  Description:
+    This file contains the extended advertising sets of the broadcaster, the
+    extended scan with the sync bookkeeping of the observer and the encoding
+    of the record in the periodic advertising data. Nothing is built unless
+    APP_BLE_PERI_ADV_MODE selects one of the roles.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "configuration.h"
+#include "system/console/sys_console.h"
+#include "mba_error_defs.h"
+#include "app_ble_adv.h"
+#include "app_ble_ad_filter.h"
+#include "app_ble_peri_adv.h"
+
+#if APP_BLE_PERI_ADV_EXTENDED
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+/* AD length, type and company identifier in front of the record */
+#define APP_BLE_PERI_ADV_HEADER_LEN             (4U)
+
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_BROADCASTER)
+static uint8_t                  s_trainAdvData[APP_BLE_PERI_ADV_HEADER_LEN];
+static uint8_t                  s_trainData[APP_BLE_PERI_ADV_DATA_LEN];
+static uint16_t                 s_trainSequence;
+#else
+static APP_BLE_PeriAdvPeer_T    s_peers[APP_BLE_PERI_ADV_MAX_SYNC];
+static const APP_BLE_AdFilter_T s_trainFilter =
+{
+    .require = APP_BLE_AD_MATCH_COMPANY,
+    .companyId = APP_BLE_ADV_COMPANY_ID,
+};
+static bool                     s_syncPending;      /* one create sync at a time */
+static uint8_t                  s_syncPendingSeconds;
+#endif
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+static void APP_BLE_PeriAdv_PutHeader(uint8_t *p_buf, uint8_t adLen)
+{
+    p_buf[0] = adLen;
+    p_buf[1] = APP_BLE_AD_TYPE_MANUFACTURER;
+    p_buf[2] = (uint8_t)APP_BLE_ADV_COMPANY_ID;
+    p_buf[3] = (uint8_t)(APP_BLE_ADV_COMPANY_ID >> 8);
+}
+
+void APP_BLE_PeriAdv_InitAdv(void)
+{
+    (void)BLE_GAP_ExtAdvInit();
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_BROADCASTER)
+    (void)BLE_GAP_PeriodicAdvInit();
+#endif
+}
+
+void APP_BLE_PeriAdv_InitScan(void)
+{
+    // both roles scan for the door remote
+    (void)BLE_GAP_ExtScanInit(BLE_GAP_EXT_SCAN_DATA_LEN_MIN, 0U);
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_OBSERVER)
+    (void)BLE_GAP_SyncInit();
+#endif
+}
+
+void APP_BLE_PeriAdv_InitConn(void)
+{
+    (void)BLE_GAP_ExtConnCentralInit();
+}
+
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_BROADCASTER)
+static void APP_BLE_PeriAdv_SetTrainData(const motorTlmRecord_t *p_rec)
+{
+    BLE_GAP_PeriAdvDataParams_T periData;
+
+    APP_BLE_PeriAdv_PutHeader(s_trainData, (uint8_t)(APP_BLE_PERI_ADV_DATA_LEN - 1U));
+    (void)Motor_Telemetry_Encode(p_rec, &s_trainData[APP_BLE_PERI_ADV_HEADER_LEN]);
+
+    periData.advHandle = APP_BLE_PERI_ADV_TRAIN_HANDLE;
+    periData.operation = BLE_GAP_PERIODIC_ADV_DATA_OP_COMPLETE;
+    periData.advLen = APP_BLE_PERI_ADV_DATA_LEN;
+    periData.p_advData = s_trainData;
+    (void)BLE_GAP_SetPeriAdvData(&periData);
+}
+#endif
+
+void APP_BLE_PeriAdv_Config(void)
+{
+    BLE_GAP_ExtAdvParams_T      advParams;
+    int8_t                      selectedTxPower;
+
+    // Connectable advertising, legacy ADV_IND PDUs
+    (void)memset(&advParams, 0, sizeof(advParams));
+    advParams.advHandle = APP_BLE_PERI_ADV_CONN_HANDLE;
+    advParams.evtProperies = BLE_GAP_EXT_ADV_EVT_PROP_LEGACY_ADV | BLE_GAP_EXT_ADV_EVT_PROP_CONNECTABLE_ADV |
+                             BLE_GAP_EXT_ADV_EVT_PROP_SCANNABLE_ADV;
+    advParams.priIntervalMin = CONFIG_BLE_GAP_ADV_INTERVAL_MIN;
+    advParams.priIntervalMax = CONFIG_BLE_GAP_ADV_INTERVAL_MAX;
+    advParams.priChannelMap = CONFIG_BLE_GAP_ADV_CHANNEL_MAP;
+    advParams.filterPolicy = CONFIG_BLE_GAP_ADV_FILT_POLICY;
+    advParams.txPower = CONFIG_BLE_GAP_ADV_TX_PWR;
+    advParams.priPhy = BLE_GAP_PHY_TYPE_LE_1M;
+    advParams.secPhy = BLE_GAP_PHY_TYPE_LE_1M;
+    (void)BLE_GAP_SetExtAdvParams(&advParams, &selectedTxPower);
+
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_BROADCASTER)
+    BLE_GAP_ExtAdvDataParams_T  advData;
+    BLE_GAP_PeriAdvParams_T     periParams;
+    motorTlmRecord_t            record;
+
+    // Non-connectable set that carries the periodic train
+    advParams.advHandle = APP_BLE_PERI_ADV_TRAIN_HANDLE;
+    advParams.evtProperies = 0U;
+    advParams.sid = APP_BLE_PERI_ADV_SID;
+    (void)BLE_GAP_SetExtAdvParams(&advParams, &selectedTxPower);
+
+    // The company identifier alone tells an observer to sync
+    APP_BLE_PeriAdv_PutHeader(s_trainAdvData, (uint8_t)(APP_BLE_PERI_ADV_HEADER_LEN - 1U));
+    advData.advHandle = APP_BLE_PERI_ADV_TRAIN_HANDLE;
+    advData.operation = BLE_GAP_EXT_ADV_DATA_OP_COMPLETE;
+    advData.fragPreference = BLE_GAP_EXT_ADV_DATA_FRAG_MIN;
+    advData.advLen = APP_BLE_PERI_ADV_HEADER_LEN;
+    advData.p_advData = s_trainAdvData;
+    (void)BLE_GAP_SetExtAdvData(&advData);
+
+    periParams.advHandle = APP_BLE_PERI_ADV_TRAIN_HANDLE;
+    periParams.intervalMin = APP_BLE_PERI_ADV_INTERVAL;
+    periParams.intervalMax = APP_BLE_PERI_ADV_INTERVAL;
+    periParams.properties = 0U;
+    (void)BLE_GAP_SetPeriAdvParams(&periParams);
+
+    (void)memset(&record, 0, sizeof(record));
+    APP_BLE_PeriAdv_SetTrainData(&record);
+#endif
+}
+
+uint16_t APP_BLE_PeriAdv_SetConnData(uint8_t *p_data, uint8_t len)
+{
+    BLE_GAP_ExtAdvDataParams_T advData;
+
+    advData.advHandle = APP_BLE_PERI_ADV_CONN_HANDLE;
+    advData.operation = BLE_GAP_EXT_ADV_DATA_OP_COMPLETE;
+    advData.fragPreference = BLE_GAP_EXT_ADV_DATA_FRAG_MIN;
+    advData.advLen = len;
+    advData.p_advData = p_data;
+    return BLE_GAP_SetExtAdvData(&advData);
+}
+
+uint16_t APP_BLE_PeriAdv_StartConnectable(void)
+{
+    BLE_GAP_ExtAdvEnableParams_T enable;
+
+    enable.advHandle = APP_BLE_PERI_ADV_CONN_HANDLE;
+    enable.duration = 0U;
+    enable.maxExtAdvEvts = 0U;
+    return BLE_GAP_SetExtAdvEnable(true, 1U, &enable);
+}
+
+static uint16_t APP_BLE_PeriAdv_StartScan(void)
+{
+    BLE_GAP_ExtScanningPhy_T    scanPhy;
+    BLE_GAP_ExtScanningEnable_T scanEnable;
+
+    (void)memset(&scanPhy, 0, sizeof(scanPhy));
+    scanPhy.le1mPhy.enable = true;
+    scanPhy.le1mPhy.type = CONFIG_BLE_GAP_SCAN_TYPE;
+    scanPhy.le1mPhy.interval = CONFIG_BLE_GAP_SCAN_INTERVAL;
+    scanPhy.le1mPhy.window = CONFIG_BLE_GAP_SCAN_WINDOW;
+    scanPhy.le1mPhy.disChannel = CONFIG_BLE_GAP_SCAN_DIS_CHANNEL_MAP;
+    (void)BLE_GAP_SetExtScanningParams(CONFIG_BLE_GAP_SCAN_FILT_POLICY, &scanPhy);
+
+    scanEnable.enable = true;
+    scanEnable.filterDuplicates = BLE_GAP_SCAN_FD_DISABLE;
+    scanEnable.duration = 0U;
+    scanEnable.period = 0U;
+    return BLE_GAP_SetExtScanningEnable(BLE_GAP_SCAN_MODE_OBSERVER, &scanEnable);
+}
+
+void APP_BLE_PeriAdv_Start(void)
+{
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_BROADCASTER)
+    BLE_GAP_ExtAdvEnableParams_T enable;
+
+    // The train starts with its advertising set
+    (void)BLE_GAP_SetPeriAdvEnable(true, APP_BLE_PERI_ADV_TRAIN_HANDLE);
+    enable.advHandle = APP_BLE_PERI_ADV_TRAIN_HANDLE;
+    enable.duration = 0U;
+    enable.maxExtAdvEvts = 0U;
+    if (BLE_GAP_SetExtAdvEnable(true, 1U, &enable) == MBA_RES_SUCCESS)
+    {
+        SYS_CONSOLE_PRINT("Periodic advertising %u\r\n", APP_BLE_PERI_ADV_INTERVAL);
+    }
+    // legacy scanning is not available any more, the door remote is found by the extended scan
+    if (APP_BLE_PeriAdv_StartScan() == MBA_RES_SUCCESS)
+    {
+        SYS_CONSOLE_MESSAGE("Scanning \r\n");
+    }
+#else
+    if (APP_BLE_PeriAdv_StartScan() == MBA_RES_SUCCESS)
+    {
+        SYS_CONSOLE_MESSAGE("Scanning for periodic advertising\r\n");
+    }
+#endif
+}
+
+uint16_t APP_BLE_PeriAdv_Connect(const BLE_GAP_CreateConnParams_T *p_params)
+{
+    BLE_GAP_ExtCreateConnPhy_T  connPhy;
+    BLE_GAP_Addr_T              peerAddr = p_params->peerAddr;
+
+    // same scan and connection parameters, on the 1M PHY only
+    (void)memset(&connPhy, 0, sizeof(connPhy));
+    connPhy.le1mPhy.enable = true;
+    connPhy.le1mPhy.scanInterval = p_params->scanInterval;
+    connPhy.le1mPhy.scanWindow = p_params->scanWindow;
+    connPhy.le1mPhy.connParams = p_params->connParams;
+    return BLE_GAP_ExtCreateConnection(p_params->filterPolicy, &peerAddr, &connPhy);
+}
+
+void APP_BLE_PeriAdv_Tick(const motorTlmRecord_t *p_rec)
+{
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_BROADCASTER)
+    motorTlmRecord_t record = *p_rec;
+
+    // observers count gaps in the sequence
+    record.sequence = ++s_trainSequence;
+    APP_BLE_PeriAdv_SetTrainData(&record);
+#else
+    (void)p_rec;
+    if (s_syncPending && (++s_syncPendingSeconds >= APP_BLE_PERI_ADV_SYNC_PENDING_MAX))
+    {
+        // the advertiser went away before the controller caught its train
+        if (BLE_GAP_CreateSyncCancel() == MBA_RES_SUCCESS)
+        {
+            s_syncPending = false;
+        }
+    }
+#endif
+}
+
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_OBSERVER)
+static APP_BLE_PeriAdvPeer_T *APP_BLE_PeriAdv_FindBySync(uint16_t syncHandle)
+{
+    uint8_t i;
+
+    for (i = 0U; i < APP_BLE_PERI_ADV_MAX_SYNC; i++)
+    {
+        if (s_peers[i].inUse && (s_peers[i].syncHandle == syncHandle))
+        {
+            return &s_peers[i];
+        }
+    }
+    return NULL;
+}
+
+static APP_BLE_PeriAdvPeer_T *APP_BLE_PeriAdv_FindByAddr(const BLE_GAP_Addr_T *p_addr, uint8_t sid)
+{
+    uint8_t i;
+
+    for (i = 0U; i < APP_BLE_PERI_ADV_MAX_SYNC; i++)
+    {
+        if (s_peers[i].inUse && (s_peers[i].sid == sid) && (s_peers[i].addr.addrType == p_addr->addrType) &&
+            (memcmp(s_peers[i].addr.addr, p_addr->addr, GAP_MAX_BD_ADDRESS_LEN) == 0))
+        {
+            return &s_peers[i];
+        }
+    }
+    return NULL;
+}
+
+static APP_BLE_PeriAdvPeer_T *APP_BLE_PeriAdv_FindFree(void)
+{
+    uint8_t i;
+
+    for (i = 0U; i < APP_BLE_PERI_ADV_MAX_SYNC; i++)
+    {
+        if (!s_peers[i].inUse)
+        {
+            return &s_peers[i];
+        }
+    }
+    return NULL;
+}
+#endif
+
+void APP_BLE_PeriAdv_ExtAdvReport(const BLE_GAP_EvtExtAdvReport_T *p_report)
+{
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_OBSERVER)
+    BLE_GAP_CreateSync_T    createSync;
+    uint32_t                syncTimeout;
+
+    if (s_syncPending || (p_report->periodAdvInterval == 0U) || (p_report->sid > BLE_GAP_ADV_SID_MAX))
+    {
+        return;
+    }
+    if (!APP_BLE_AdFilter_IsMatch(&s_trainFilter, p_report->advData, p_report->length) ||
+        (APP_BLE_PeriAdv_FindByAddr(&p_report->addr, p_report->sid) != NULL) ||
+        (APP_BLE_PeriAdv_FindFree() == NULL))
+    {
+        return;
+    }
+
+    // 1.25 ms interval units to 10 ms timeout units
+    syncTimeout = ((uint32_t)p_report->periodAdvInterval * APP_BLE_PERI_ADV_SYNC_TIMEOUT_INTERVALS) / 8U;
+    if (syncTimeout < BLE_GAP_SYNC_TIMEOUT_MIN)
+    {
+        syncTimeout = BLE_GAP_SYNC_TIMEOUT_MIN;
+    }
+    else if (syncTimeout > BLE_GAP_SYNC_TIMEOUT_MAX)
+    {
+        syncTimeout = BLE_GAP_SYNC_TIMEOUT_MAX;
+    }
+
+    (void)memset(&createSync, 0, sizeof(createSync));
+    createSync.advSid = p_report->sid;
+    createSync.advAddr = p_report->addr;
+    createSync.skip = 0U;
+    createSync.syncTimeout = (uint16_t)syncTimeout;
+    if (BLE_GAP_CreateSync(&createSync) == MBA_RES_SUCCESS)
+    {
+        s_syncPending = true;
+        s_syncPendingSeconds = 0U;
+    }
+#else
+    (void)p_report;
+#endif
+}
+
+void APP_BLE_PeriAdv_SyncEst(const BLE_GAP_EvtPeriAdvSyncEst_T *p_est)
+{
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_OBSERVER)
+    APP_BLE_PeriAdvPeer_T *p_peer;
+
+    s_syncPending = false;
+    if (p_est->status != GAP_STATUS_SUCCESS)
+    {
+        return;
+    }
+    p_peer = APP_BLE_PeriAdv_FindFree();
+    if (p_peer == NULL)
+    {
+        (void)BLE_GAP_TerminateSync(p_est->syncHandle);
+        return;
+    }
+    (void)memset(p_peer, 0, sizeof(APP_BLE_PeriAdvPeer_T));
+    p_peer->inUse = true;
+    p_peer->syncHandle = p_est->syncHandle;
+    p_peer->addr = p_est->advAddr;
+    p_peer->sid = p_est->advSid;
+    SYS_CONSOLE_PRINT("Sync %u motor %02X:%02X:%02X:%02X:%02X:%02X interval %u\r\n", p_est->syncHandle,
+        p_est->advAddr.addr[5], p_est->advAddr.addr[4], p_est->advAddr.addr[3],
+        p_est->advAddr.addr[2], p_est->advAddr.addr[1], p_est->advAddr.addr[0], p_est->periAdvInterval);
+#else
+    (void)p_est;
+#endif
+}
+
+void APP_BLE_PeriAdv_Report(const BLE_GAP_EvtPeriAdvReport_T *p_report)
+{
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_OBSERVER)
+    APP_BLE_PeriAdvPeer_T   *p_peer;
+    motorTlmRecord_t        record;
+    uint8_t                 header[APP_BLE_PERI_ADV_HEADER_LEN];
+    const uint8_t           *p_data = p_report->advData;
+
+    p_peer = APP_BLE_PeriAdv_FindBySync(p_report->syncHandle);
+    if ((p_peer == NULL) || (p_report->dataStatus != BLE_GAP_DATA_STATUS_COMPLETE) ||
+        (p_report->dataLength < APP_BLE_PERI_ADV_DATA_LEN))
+    {
+        return;
+    }
+    APP_BLE_PeriAdv_PutHeader(header, (uint8_t)(APP_BLE_PERI_ADV_DATA_LEN - 1U));
+    if ((memcmp(p_data, header, APP_BLE_PERI_ADV_HEADER_LEN) != 0) ||
+        !Motor_Telemetry_Decode(&p_data[APP_BLE_PERI_ADV_HEADER_LEN], MOTOR_TLM_RECORD_LEN, &record))
+    {
+        return;
+    }
+    if (p_peer->reports != 0U)
+    {
+        if (record.sequence == p_peer->record.sequence)
+        {
+            // periodic interval shorter than the record refresh
+            p_peer->rssi = p_report->rssi;
+            return;
+        }
+        p_peer->missed += (uint16_t)(record.sequence - p_peer->record.sequence - 1U);
+    }
+    if ((p_peer->reports == 0U) || (record.state != p_peer->record.state) || (record.flags != p_peer->record.flags))
+    {
+        SYS_CONSOLE_PRINT("Motor %u state %u rpm %ld flags 0x%02X\r\n", p_peer->syncHandle, record.state,
+            (long)(record.rpmQ16 / 65536), record.flags);
+    }
+    p_peer->rssi = p_report->rssi;
+    p_peer->reports++;
+    p_peer->record = record;
+#else
+    (void)p_report;
+#endif
+}
+
+void APP_BLE_PeriAdv_SyncLost(const BLE_GAP_EvtPeriAdvSyncLost_T *p_lost)
+{
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_OBSERVER)
+    APP_BLE_PeriAdvPeer_T *p_peer = APP_BLE_PeriAdv_FindBySync(p_lost->syncHandle);
+
+    if (p_peer != NULL)
+    {
+        // scanning goes on, the next report of the motor syncs again
+        SYS_CONSOLE_PRINT("Sync %u lost, %lu reports %lu missed\r\n", p_peer->syncHandle,
+            (unsigned long)p_peer->reports, (unsigned long)p_peer->missed);
+        p_peer->inUse = false;
+    }
+#else
+    (void)p_lost;
+#endif
+}
+
+const APP_BLE_PeriAdvPeer_T *APP_BLE_PeriAdv_GetPeer(uint8_t index)
+{
+#if (APP_BLE_PERI_ADV_MODE == APP_BLE_PERI_ADV_OBSERVER)
+    if ((index < APP_BLE_PERI_ADV_MAX_SYNC) && s_peers[index].inUse)
+    {
+        return &s_peers[index];
+    }
+#else
+    (void)index;
+#endif
+    return NULL;
+}
+
+#endif /* APP_BLE_PERI_ADV_EXTENDED */
+
+/* *****************************************************************************
+ End of File
+ */
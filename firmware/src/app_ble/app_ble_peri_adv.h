@@ -0,0 +1,185 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Application BLE Periodic Advertising Header File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    app_ble_peri_adv.h
+
+  Summary:
+    This header file provides the periodic advertising of the telemetry
+    record and the observer that follows it on other motors.
+
+  Description:
+    APP_BLE_PERI_ADV_MODE selects one of three builds:
+
+    - APP_BLE_PERI_ADV_OFF, the default. Legacy advertising and scanning as
+      configured by MCC, nothing in this module is used.
+    - APP_BLE_PERI_ADV_BROADCASTER. Next to the connectable advertising a
+      second, non-connectable advertising set runs a periodic advertising
+      train that carries the telemetry record. Any number of head units can
+      synchronize to it at no cost to the motor.
+    - APP_BLE_PERI_ADV_OBSERVER. The device scans for motors announcing a
+      train, synchronizes to up to APP_BLE_PERI_ADV_MAX_SYNC of them and
+      keeps the last record of each.
+
+    The stack rejects legacy advertising and scanning commands once any
+    extended advertising command is used. In both non-default modes the
+    connectable advertising therefore runs as extended advertising set
+    APP_BLE_PERI_ADV_CONN_HANDLE with legacy PDUs, so centrals see the same
+    ADV_IND as before. Legacy scanning is replaced by an extended scan with
+    the MCC scan settings in both modes; its reports of legacy connectable
+    PDUs go through the same door remote filter as the legacy reports, and
+    the remote is connected with APP_BLE_PeriAdv_Connect.
+
+    The periodic advertising data is one manufacturer specific AD structure:
+
+      Offset  Size  Field
+       0      1     AD length, 25
+       1      1     AD type, manufacturer specific data
+       2      2     company identifier, APP_BLE_ADV_COMPANY_ID
+       4      22    telemetry record, see Motor_Telemetry_Encode
+
+    The extended advertising of the train carries the same company
+    identifier, which is what the observer filters on before creating a
+    sync.
+*******************************************************************************/
+
+#ifndef APP_BLE_PERI_ADV_H
+#define APP_BLE_PERI_ADV_H
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_gap.h"
+#include "motor_telemetry.h"
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus  // Provide C++ Compatibility
+
+extern "C" {
+
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Macros
+// *****************************************************************************
+// *****************************************************************************
+#define APP_BLE_PERI_ADV_OFF                (0U)
+#define APP_BLE_PERI_ADV_BROADCASTER        (1U)
+#define APP_BLE_PERI_ADV_OBSERVER           (2U)
+
+/**@brief Role of this device, may be overridden from the project settings. */
+#ifndef APP_BLE_PERI_ADV_MODE
+#define APP_BLE_PERI_ADV_MODE               APP_BLE_PERI_ADV_OFF
+#endif
+
+/**@brief Advertising uses the extended advertising commands. */
+#define APP_BLE_PERI_ADV_EXTENDED           (APP_BLE_PERI_ADV_MODE != APP_BLE_PERI_ADV_OFF)
+
+/**@brief Periodic advertising interval. Unit: 1.25 ms. */
+#ifndef APP_BLE_PERI_ADV_INTERVAL
+#define APP_BLE_PERI_ADV_INTERVAL           (400U)
+#endif
+
+/**@brief Advertising set handles. */
+#define APP_BLE_PERI_ADV_CONN_HANDLE        (0U)        /* connectable, legacy PDUs */
+#define APP_BLE_PERI_ADV_TRAIN_HANDLE       (1U)        /* non-connectable, periodic train */
+
+/**@brief Advertising SID of the periodic train. */
+#define APP_BLE_PERI_ADV_SID                (1U)
+
+/**@brief Length of the periodic advertising data. */
+#define APP_BLE_PERI_ADV_DATA_LEN           (4U + MOTOR_TLM_RECORD_LEN)
+
+/**@brief Motors the observer follows at the same time. */
+#define APP_BLE_PERI_ADV_MAX_SYNC           (4U)
+
+/**@brief Seconds a sync request may stay pending before it is cancelled. */
+#define APP_BLE_PERI_ADV_SYNC_PENDING_MAX   (5U)
+
+/**@brief Periodic advertising intervals without a packet before the sync is lost. */
+#define APP_BLE_PERI_ADV_SYNC_TIMEOUT_INTERVALS  (6U)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+/**@brief A motor followed by the observer. */
+typedef struct APP_BLE_PeriAdvPeer_T
+{
+    bool                    inUse;
+    uint16_t                syncHandle;
+    BLE_GAP_Addr_T          addr;
+    uint8_t                 sid;
+    int8_t                  rssi;
+    uint32_t                reports;                /* records received */
+    uint32_t                missed;                 /* gaps in the record sequence */
+    motorTlmRecord_t        record;                 /* last record received */
+} APP_BLE_PeriAdvPeer_T;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Function Prototypes
+// *****************************************************************************
+// *****************************************************************************
+void APP_BLE_PeriAdv_InitAdv(void);
+void APP_BLE_PeriAdv_InitScan(void);
+void APP_BLE_PeriAdv_InitConn(void);
+void APP_BLE_PeriAdv_Config(void);
+uint16_t APP_BLE_PeriAdv_SetConnData(uint8_t *p_data, uint8_t len);
+uint16_t APP_BLE_PeriAdv_StartConnectable(void);
+void APP_BLE_PeriAdv_Start(void);
+uint16_t APP_BLE_PeriAdv_Connect(const BLE_GAP_CreateConnParams_T *p_params);
+void APP_BLE_PeriAdv_Tick(const motorTlmRecord_t *p_rec);
+void APP_BLE_PeriAdv_ExtAdvReport(const BLE_GAP_EvtExtAdvReport_T *p_report);
+void APP_BLE_PeriAdv_SyncEst(const BLE_GAP_EvtPeriAdvSyncEst_T *p_est);
+void APP_BLE_PeriAdv_Report(const BLE_GAP_EvtPeriAdvReport_T *p_report);
+void APP_BLE_PeriAdv_SyncLost(const BLE_GAP_EvtPeriAdvSyncLost_T *p_lost);
+const APP_BLE_PeriAdvPeer_T *APP_BLE_PeriAdv_GetPeer(uint8_t index);
+
+//DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+//DOM-IGNORE-END
+
+#endif /* APP_BLE_PERI_ADV_H */
+
+/*******************************************************************************
+ End of File
+ */
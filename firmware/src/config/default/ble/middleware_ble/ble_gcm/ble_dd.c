@@ -47,6 +47,7 @@
 // *****************************************************************************
 #include <string.h>
 #include "osal/osal_freertos_extend.h"
+#include "osal_pool.h"
 #include "mba_error_defs.h"
 #include "ble_gap.h"
 #include "gatt.h"
@@ -135,14 +136,14 @@ static void ble_dd_FreeConn(BLE_DD_Conn_T *p_conn)
 
     if (p_conn->p_discInstance != NULL)
     {
-        OSAL_Free(p_conn->p_discInstance);
+        OSAL_POOL_Free(p_conn->p_discInstance);
     }
 
     for (i=0; i<BLE_GAP_MAX_LINK_NBR; i++)
     {
         if (sp_ddCtrl->conn[i] == p_conn)
         {
-            OSAL_Free(sp_ddCtrl->conn[i]);
+            OSAL_POOL_Free(sp_ddCtrl->conn[i]);
             sp_ddCtrl->conn[i] = NULL;
         
             break;
@@ -169,7 +170,7 @@ static BLE_DD_Conn_T *ble_dd_GetFreeConn(void)
     {
         if (sp_ddCtrl->conn[i] == NULL)
         {
-            sp_ddCtrl->conn[i] = OSAL_Malloc(sizeof(BLE_DD_Conn_T));
+            sp_ddCtrl->conn[i] = OSAL_POOL_Malloc(sizeof(BLE_DD_Conn_T));
             if (sp_ddCtrl->conn[i] != NULL)
             {
                 (void)memset((uint8_t *)sp_ddCtrl->conn[i], 0, sizeof(BLE_DD_Conn_T));
@@ -438,7 +439,7 @@ static void ble_dd_StackEvtBleGapHandler(BLE_DD_Config_T *p_config, BLE_GAP_Even
                     p_conn->connHandle = p_event->eventField.evtConnect.connHandle;
                     p_conn->discSvcIndex = 0;
                     p_conn->gapRole = p_event->eventField.evtConnect.role;
-                    p_conn->p_discInstance = OSAL_Malloc(sizeof(BLE_DD_DiscInstance_T));
+                    p_conn->p_discInstance = OSAL_POOL_Malloc(sizeof(BLE_DD_DiscInstance_T));
 
                     for (i=0; i<sp_ddCtrl->numOfService; i++)
                     {
@@ -71,12 +71,12 @@ static const uint8_t s_ctrlSvcUuid[] = {UUID_CTRL_PRIMARY_SVC_LE};
 static const uint16_t s_ctrlSvcUuidLen = sizeof(s_ctrlSvcUuid);
 
 /* Ctrl Characteristic 0 Characteristic */
-static const uint8_t s_ctrlChar0[] = {ATT_PROP_READ|ATT_PROP_WRITE_REQ, UINT16_TO_BYTES(CTRL_HDL_CHARVAL_0), UUID_CTRL_CHARACTERISTIC_0_LE};    /* Read */ /* Write with response */
+static const uint8_t s_ctrlChar0[] = {ATT_PROP_READ|ATT_PROP_WRITE_REQ|ATT_PROP_WRITE_CMD, UINT16_TO_BYTES(CTRL_HDL_CHARVAL_0), UUID_CTRL_CHARACTERISTIC_0_LE};    /* Read */ /* Write with response */ /* Write without response */
 static const uint16_t s_ctrlChar0Len = sizeof(s_ctrlChar0);
 
 /* Ctrl Characteristic 0 Characteristic Value */
 static const uint8_t s_ctrlUuidChar0[] = {UUID_CTRL_CHARACTERISTIC_0_LE};
-static uint8_t s_ctrlChar0Val[4] = {0x0};    /* Default Value */
+static uint8_t s_ctrlChar0Val[244] = {0x0};    /* Default Value */
 static uint16_t s_ctrlChar0ValLen = sizeof(s_ctrlChar0Val);
 
 /* Ctrl Characteristic 1 Characteristic */
@@ -85,7 +85,7 @@ static const uint16_t s_ctrlChar1Len = sizeof(s_ctrlChar1);
 
 /* Ctrl Characteristic 1 Characteristic Value */
 static const uint8_t s_ctrlUuidChar1[] = {UUID_CTRL_CHARACTERISTIC_1_LE};
-static uint8_t s_ctrlChar1Val[128] = {0x0};    /* Default Value */
+static uint8_t s_ctrlChar1Val[244] = {0x0};    /* Default Value */
 uint16_t s_ctrlChar1ValLen = sizeof(s_ctrlChar1Val);
 
 /* Ctrl Characteristic 1 Client Characteristic Configuration Descriptor */
@@ -118,7 +118,7 @@ static GATTS_Attribute_T s_ctrlList[] = {
         (uint8_t *) s_ctrlChar0Val,
         (uint16_t *) & s_ctrlChar0ValLen,
         sizeof(s_ctrlChar0Val),
-        0,    
+        SETTING_MANUAL_WRITE_RSP|SETTING_VARIABLE_LEN,    /* Manual Write Response */ /* Variable Length */
         PERMISSION_READ|PERMISSION_WRITE    
     },
     /* Characteristic 1 Declaration */
@@ -50,83 +50,1197 @@
 
 static motorState_t motorState = MOTOR_OFF;
 static motorDirection_t motorDirection = MOTOR_FORWARD;
-uint32_t pwmPeriod = 400;
-uint32_t lastSpeed = 50;
+/* direction the H-bridge was driven last */
+static motorDirection_t bridgeDirection = MOTOR_FORWARD;
+static motorCtrlMode_t motorMode = MOTOR_MODE_OPEN_LOOP;
+uint32_t pwmPeriod = MOTOR_PWM_PERIOD;
+/* open loop duty restored by Motor_Start(), Q16 */
+static uint32_t lastDutyQ16 = MOTOR_DUTY_Q16_MAX / 2U;
 
+static motorPI_t speedPI;
+static motorProfile_t ramp;
+static int16_t speedRefQ15 = 0;
+static uint32_t dutyQ16 = 0;
+static motorVelocity_t velocity;
+static uint32_t lastSampleCycles = 0;
+static motorCtrlStats_t ctrlStats;
 
+static volatile uint32_t pendingDuty;
+static volatile bool dutyPending = false;
+static volatile uint32_t dutyCountsQ16 = 0;
+static volatile bool dutyDither = false;
+static uint32_t ditherAcc = 0;
+static uint32_t pwmPeriodCount = 0;
+static uint32_t lastTickCycles = 0;
 
-void Motor_Start()
+static uint32_t rampAccel = MOTOR_RAMP_ACCEL_DEFAULT;
+static uint32_t rampJerk = MOTOR_RAMP_JERK_DEFAULT;
+static int32_t moveRateMax;
+static int32_t moveRateStep;
+static int32_t moveTarget = 0;
+static int32_t positionMin = -MOTOR_POS_RANGE;
+static int32_t positionMax = MOTOR_POS_RANGE;
+static uint32_t settleTicks = 0;
+/* ramp up again in motorDirection once the motor is braked */
+static bool restartPending = false;
+/* control ticks spent in MOTOR_BRAKING or MOTOR_DEAD_TIME */
+static uint32_t phaseTicks = 0;
+static volatile bool faulted = false;
+static bool travelFaultArmed = false;
+static MOTOR_EVENT_CALLBACK eventCallback = NULL;
+static uintptr_t eventContext = 0;
+
+/* Commands from the application task, executed by the control loop */
+static motorMailbox_t commands;
+/* Motor_EmergencyStop() bumps the request count, the control loop stops the
+   motor when it differs from the count it handled last */
+static volatile uint32_t stopRequests = 0;
+static uint32_t stopRequestsDone = 0;
+
+/* Control loop samples for the application task, every decimation ticks */
+static motorTlmStream_t stream;
+static uint16_t tickIndex = 0;
+static uint8_t streamDivider = 0;
+
+typedef enum {
+    MOTOR_CMD_START = 0,
+    MOTOR_CMD_STOP,
+    MOTOR_CMD_TOGGLE,
+    MOTOR_CMD_REVERSE,
+    MOTOR_CMD_DUTY,
+    MOTOR_CMD_DITHER,
+    MOTOR_CMD_SPEED_RPM,
+    MOTOR_CMD_SPEED_GAINS,
+    MOTOR_CMD_RAMP_LIMITS,
+    MOTOR_CMD_MOVE_TO,
+    MOTOR_CMD_MOVE_BY,
+    MOTOR_CMD_SET_POSITION,
+    MOTOR_CMD_POSITION_LIMITS,
+    MOTOR_CMD_MOVE_LIMITS,
+    MOTOR_CMD_FAULT_CLEAR,
+    MOTOR_CMD_RESET_STATS,
+    MOTOR_CMD_TELEMETRY
+} motorCmdId_t;
+
+
+static int32_t motor_DutyQ16ToQ31(uint32_t duty)
 {
-    motorState = MOTOR_ON;
-    /* Start PWM*/
-    Motor_SetSpeed(lastSpeed);
-    TCC1_PWMStart();
+    return (duty >= MOTOR_DUTY_Q16_MAX) ? INT32_MAX : (int32_t)(duty << 15);
+}
+
+static int16_t motor_DutyQ15(void)
+{
+    return (dutyQ16 >= MOTOR_DUTY_Q16_MAX) ? MOTOR_Q15_MAX : (int16_t)(dutyQ16 >> 1);
+}
+
+static int16_t motor_SpeedQ15(void)
+{
+    int32_t rpmQ16 = velocity.rpmQ16;
+    int32_t speedQ15;
+
+    if (rpmQ16 < 0)
+    {
+        rpmQ16 = -rpmQ16;
+    }
+    // rpm / base in Q15
+    speedQ15 = rpmQ16 / (int32_t)(2U * MOTOR_SPEED_BASE_RPM);
+    return (speedQ15 > MOTOR_Q15_MAX) ? MOTOR_Q15_MAX : (int16_t)speedQ15;
+}
+
+static int16_t motor_SpeedQ15Signed(void)
+{
+    int32_t speedQ15 = (velocity.rpmQ16 * MOTOR_QEI_DIRECTION) / (int32_t)(2U * MOTOR_SPEED_BASE_RPM);
+
+    if (speedQ15 > MOTOR_Q15_MAX)
+    {
+        return MOTOR_Q15_MAX;
+    }
+    return (speedQ15 < -MOTOR_Q15_MAX) ? -MOTOR_Q15_MAX : (int16_t)speedQ15;
+}
+
+static int32_t motor_PositionGet(void)
+{
+    return (int32_t)QEI_PositionGet() * MOTOR_QEI_DIRECTION;
+}
+
+static int32_t motor_PositionClamp(int32_t position)
+{
+    if (position > positionMax)
+    {
+        return positionMax;
+    }
+    return (position < positionMin) ? positionMin : position;
+}
+
+static void motor_SetDuty(uint32_t duty)
+{
+    if (!TCC1_PWM24bitDutySet(TCC1_CHANNEL1, duty))
+    {
+        // buffer still holds the previous value, apply it on the next period
+        pendingDuty = duty;
+        dutyPending = true;
+    }
+    else
+    {
+        dutyPending = false;
+        Motor_Latency_Actuated();
+    }
+}
+
+static void motor_ApplyDutyQ16(uint32_t duty)
+{
+    // duty in TCC counts with a 16 bit fraction, 100 % is PER + 1 in NPWM
+    uint32_t countsQ16 = duty * (pwmPeriod + 1U);
+
+    dutyQ16 = duty;
+    dutyCountsQ16 = countsQ16;
+    if (!dutyDither)
+    {
+        motor_SetDuty((countsQ16 + 0x8000U) >> 16);
+    }
 }
 
-void Motor_Stop()
+/* Cuts the drive and lets the motor coast, PWM keeps running so the control
+   loop keeps ticking */
+static void motor_Off(void)
 {
     motorState = MOTOR_OFF;
-    TCC1_PWMStop();
-    // braking (should brake for 0.1 seconds before issuing start again))
+    restartPending = false;
+    motor_ApplyDutyQ16(0);
     GPIO_PinClear(GPIO_PIN_RD0);
     GPIO_PinClear(GPIO_PIN_RB12);
 }
 
-void Motor_SetSpeed(uint32_t percentage)
+/* Both inputs low with the bridge enabled short the motor terminals */
+static void motor_Brake(void)
 {
-    uint32_t newDuty = pwmPeriod*percentage;
-    newDuty/=100;
-    if (!TCC1_PWM24bitDutySet(TCC1_CHANNEL1, newDuty))
+    motorState = MOTOR_BRAKING;
+    phaseTicks = 0;
+    GPIO_PinClear(GPIO_PIN_RD0);
+    GPIO_PinClear(GPIO_PIN_RB12);
+    motor_ApplyDutyQ16(MOTOR_DUTY_Q16_MAX);
+}
+
+/* TCC1 overflow once per PWM period, non-recoverable faults */
+static void motor_PwmPeriodHandler(uint32_t status, uintptr_t context)
+{
+    uint32_t now;
+    uint32_t interval;
+    uint32_t jitter;
+
+    (void)context;
+    if ((status & (TCC1_PWM_STATUS_FAULT_0 | TCC1_PWM_STATUS_FAULT_1)) != 0U)
     {
-        //SYS_CONSOLE_MESSAGE("Failed to update motor speed\r\n");
+        // the outputs are already low, bring the software state in line
+        motor_Off();
+        faulted = true;
+        if (eventCallback != NULL)
+        {
+            eventCallback(MOTOR_EVENT_FAULT, motor_PositionGet(), eventContext);
+        }
+    }
+    if ((status & TCC1_PWM_STATUS_OVF) == 0U)
+    {
+        return;
+    }
+
+    if (dutyDither)
+    {
+        // first order sigma-delta: the fraction of a count carries over
+        // periods so the average duty keeps the full Q16 resolution
+        uint32_t counts = dutyCountsQ16;
+
+        ditherAcc += counts & 0xFFFFU;
+        (void)TCC1_PWM24bitDutySet(TCC1_CHANNEL1, (counts >> 16) + (ditherAcc >> 16));
+        ditherAcc &= 0xFFFFU;
+        Motor_Latency_Actuated();
+    }
+    else if (dutyPending)
+    {
+        dutyPending = false;
+        (void)TCC1_PWM24bitDutySet(TCC1_CHANNEL1, pendingDuty);
+        Motor_Latency_Actuated();
+    }
+
+    if (++pwmPeriodCount < MOTOR_CTRL_PWM_DIVIDER)
+    {
+        return;
+    }
+    pwmPeriodCount = 0;
+
+    now = DWT->CYCCNT;
+    if (ctrlStats.iterations != 0U)
+    {
+        interval = now - lastTickCycles;
+        jitter = (interval > ctrlStats.periodCycles) ? (interval - ctrlStats.periodCycles) : (ctrlStats.periodCycles - interval);
+        if (interval < ctrlStats.intervalMin)
+        {
+            ctrlStats.intervalMin = interval;
+        }
+        if (interval > ctrlStats.intervalMax)
+        {
+            ctrlStats.intervalMax = interval;
+        }
+        if (jitter > ctrlStats.jitterMax)
+        {
+            ctrlStats.jitterMax = jitter;
+        }
+    }
+    lastTickCycles = now;
+
+    Motor_ControlTick();
+}
+
+/* The fault routing is set up here rather than in the generated EVSYS, QEI
+   and TCC1 plibs, which have no API for it and are rewritten by MCC */
+
+/* Asynchronous path: no channel clock and the lowest latency, there is no
+   edge detection on it */
+static void motor_EventChannelSet(uint32_t channel, uint32_t generator)
+{
+    EVSYS_REGS->CHANNEL[channel].EVSYS_CHANNEL = EVSYS_CHANNEL_EVGEN(generator)
+                                               | EVSYS_CHANNEL_PATH_ASYNCHRONOUS
+                                               | EVSYS_CHANNEL_EDGSEL_NO_EVT_OUTPUT;
+}
+
+/* Channel n is selected by writing n + 1, zero disconnects the user */
+static void motor_EventUserSet(uint32_t user, uint32_t channel)
+{
+    EVSYS_REGS->EVSYS_USER[user] = EVSYS_USER_CHANNEL(channel + 1U);
+}
+
+static void motor_EventUserClear(uint32_t user)
+{
+    EVSYS_REGS->EVSYS_USER[user] = 0U;
+}
+
+/* Latched and live state of the TCC1 non-recoverable faults */
+static uint32_t motor_FaultStatusGet(void)
+{
+    return TCC1_REGS->TCC_STATUS & (TCC_STATUS_FAULT0_Msk | TCC_STATUS_FAULT1_Msk
+                                   | TCC_STATUS_FAULT0IN_Msk | TCC_STATUS_FAULT1IN_Msk);
+}
+
+/* Releases the outputs, fails while a fault input is still active */
+static bool motor_FaultRelease(void)
+{
+    if ((TCC1_REGS->TCC_STATUS & (TCC_STATUS_FAULT0IN_Msk | TCC_STATUS_FAULT1IN_Msk)) != 0U)
+    {
+        return false;
+    }
+    TCC1_REGS->TCC_STATUS = TCC_STATUS_FAULT0_Msk | TCC_STATUS_FAULT1_Msk;
+    while ((TCC1_REGS->TCC_SYNCBUSY & TCC_SYNCBUSY_STATUS_Msk) == TCC_SYNCBUSY_STATUS_Msk)
+    {
+        /* Wait for sync */
+    }
+    return true;
+}
+
+/* Connects the fault sources to the TCC1 event inputs, EV0 trips FAULT0 and
+   EV1 trips FAULT1, a non-recoverable fault drives all outputs low. TCC1
+   must not be running yet, EVCTRL and DRVCTRL are enable protected. */
+static void motor_FaultRoutingInit(void)
+{
+    uint32_t evctrl = TCC1_REGS->TCC_EVCTRL & ~(TCC_EVCTRL_EVACT0_Msk | TCC_EVCTRL_EVACT1_Msk
+                                               | TCC_EVCTRL_TCEI0_Msk | TCC_EVCTRL_TCEI1_Msk);
+
+#if MOTOR_FAULT_TRAVEL_LIMIT
+    // the QEI compare output, and so its event, is active outside the window
+    QEI_REGS->QEI_QEIIOC = (QEI_REGS->QEI_QEIIOC & ~QEI_QEIIOC_OUTFNC_Msk) | QEI_QEIIOC_OUTFNC_EITHER;
+    motor_EventChannelSet(MOTOR_EVSYS_CH_TRAVEL, EVENT_ID_GEN_QEI0);
+    motor_EventUserSet(EVENT_ID_USER_TCC1_EV0, MOTOR_EVSYS_CH_TRAVEL);
+    evctrl |= TCC_EVCTRL_EVACT0_FAULT | TCC_EVCTRL_TCEI0_Msk;
+    travelFaultArmed = true;
+#endif
+#if MOTOR_FAULT_OBSTRUCTION
+    motor_EventChannelSet(MOTOR_EVSYS_CH_OBSTRUCTION, EVENT_ID_GEN_EIC_EXTINT_1);
+    motor_EventUserSet(EVENT_ID_USER_TCC1_EV1, MOTOR_EVSYS_CH_OBSTRUCTION);
+    evctrl |= TCC_EVCTRL_EVACT1_FAULT | TCC_EVCTRL_TCEI1_Msk;
+#endif
+    TCC1_REGS->TCC_EVCTRL = evctrl;
+    TCC1_REGS->TCC_DRVCTRL = (TCC1_REGS->TCC_DRVCTRL & ~(TCC_DRVCTRL_NRE_Msk | TCC_DRVCTRL_NRV_Msk))
+                            | TCC_DRVCTRL_NRE(0x3FU) | TCC_DRVCTRL_NRV(0U);
+}
+
+static void motor_SetPositionLimits(int32_t minimum, int32_t maximum)
+{
+    positionMin = (minimum < -MOTOR_POS_RANGE) ? -MOTOR_POS_RANGE : minimum;
+    positionMax = (maximum > MOTOR_POS_RANGE) ? MOTOR_POS_RANGE : maximum;
+    // the QEI compare window, a margin past the limits, trips the travel
+    // fault in hardware; the QEI compares signed counts
+    if (MOTOR_QEI_DIRECTION > 0)
+    {
+        QEI_PositionWindowSet((uint32_t)(positionMax + (int32_t)MOTOR_POS_FAULT_MARGIN),
+                              (uint32_t)(positionMin - (int32_t)MOTOR_POS_FAULT_MARGIN));
     }
     else
     {
-        //SYS_CONSOLE_PRINT("Set new duty percentage %d %d\r\n", percentage, newDuty);
+        QEI_PositionWindowSet((uint32_t)(-positionMin + (int32_t)MOTOR_POS_FAULT_MARGIN),
+                              (uint32_t)(-positionMax - (int32_t)MOTOR_POS_FAULT_MARGIN));
+    }
+}
+
+static void motor_StatsReset(void)
+{
+    ctrlStats.loopHz = MOTOR_CTRL_LOOP_HZ;
+    ctrlStats.iterations = 0;
+    ctrlStats.execCycles = 0;
+    ctrlStats.execCyclesMax = 0;
+    ctrlStats.periodCycles = MOTOR_CTRL_TICK_CYCLES;
+    ctrlStats.intervalMin = UINT32_MAX;
+    ctrlStats.intervalMax = 0;
+    ctrlStats.jitterMax = 0;
+}
+
+/* The generated TCC1 setup runs at 1/8 clock with a 401 count period, the
+   duty resolution and loop rate above need the full clock and
+   MOTOR_PWM_PERIOD. TCC1 is still disabled, so CTRLA can be written */
+static void motor_PwmConfigure(void)
+{
+    TCC1_REGS->TCC_CTRLA = (TCC1_REGS->TCC_CTRLA & ~TCC_CTRLA_PRESCALER_Msk) | TCC_CTRLA_PRESCALER_DIV1;
+    TCC1_REGS->TCC_CC[1] = 0U;
+    TCC1_REGS->TCC_PER = MOTOR_PWM_PERIOD;
+    while (TCC1_REGS->TCC_SYNCBUSY != 0U)
+    {
+        /* Wait for sync */
     }
-    lastSpeed = percentage;
+    NVIC_SetPriority(TCC1_IRQn, MOTOR_CTRL_IRQ_PRIORITY);
+}
+
+void Motor_Initialize(void)
+{
+    // DWT cycle counter is used to measure the control loop execution time
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    Motor_Velocity_Init(&velocity, MOTOR_QEI_COUNTS_PER_REV);
+    lastSampleCycles = DWT->CYCCNT;
+    Motor_PI_Init(&speedPI, MOTOR_SPEED_KP_DEFAULT, MOTOR_SPEED_KI_DEFAULT,
+                  MOTOR_SPEED_SHIFT_DEFAULT, 0, MOTOR_Q15_MAX);
+    Motor_Profile_Init(&ramp, rampAccel, rampJerk, MOTOR_CTRL_LOOP_HZ);
+    motor_SetPositionLimits(-MOTOR_POS_RANGE, MOTOR_POS_RANGE);
+    motor_StatsReset();
+    Motor_Mailbox_Init(&commands);
+    Motor_Telemetry_StreamInit(&stream, MOTOR_TLM_STREAM_LATENCY);
+    // executed by the first control loop iteration, the mailbox is empty
+    (void)Motor_SetMoveLimits(MOTOR_MOVE_SPEED_DEFAULT, MOTOR_MOVE_ACCEL_DEFAULT);
+
+    // TCC1 runs continuously, its period interrupt is the control loop timebase
+    motor_PwmConfigure();
+    motor_FaultRoutingInit();
+    motor_SetDuty(0);
+    TCC1_PWMCallbackRegister(motor_PwmPeriodHandler, (uintptr_t)NULL);
+    TCC1_PWMPeriodInterruptEnable();
+    TCC1_PWMStart();
 }
 
-void Motor_SetDirection(motorDirection_t direction)
+/* H-bridge direction pins, without changing the direction Motor_Toggle() uses */
+static void motor_DriveBridge(motorDirection_t direction)
 {
+    bridgeDirection = direction;
     if (direction == MOTOR_FORWARD)
     {
-        motorDirection = MOTOR_FORWARD;
-        GPIO_PinSet(GPIO_PIN_RB12);  
-        GPIO_PinClear(GPIO_PIN_RD0);          
+        GPIO_PinSet(GPIO_PIN_RB12);
+        GPIO_PinClear(GPIO_PIN_RD0);
     }
     else
     {
-        motorDirection = MOTOR_REVERSE;
-        GPIO_PinSet(GPIO_PIN_RD0);  
-        GPIO_PinClear(GPIO_PIN_RB12);                  
+        GPIO_PinSet(GPIO_PIN_RD0);
+        GPIO_PinClear(GPIO_PIN_RB12);
     }
 }
 
-void Motor_Toggle()
+/* Restores the speed ramp and the unipolar speed loop after a move */
+static void motor_LeavePosition(void)
 {
-    // motor toggling only if sensor is not tripped.
-    if (motorState == MOTOR_OFF)
+    if (motorMode == MOTOR_MODE_POSITION)
     {
-        // toggle direction each time motor is turned on
-        if (motorDirection == MOTOR_FORWARD)
+        Motor_Profile_SetLimits(&ramp, rampAccel, rampJerk, MOTOR_CTRL_LOOP_HZ);
+        Motor_PI_Init(&speedPI, speedPI.kp, speedPI.ki, speedPI.shift, 0, MOTOR_Q15_MAX);
+        // the ramp held a position, continue from the duty applied last
+        Motor_Profile_Reset(&ramp, motor_DutyQ15());
+        motorMode = MOTOR_MODE_OPEN_LOOP;
+        if (motorState != MOTOR_OFF)
         {
-            Motor_SetDirection(MOTOR_REVERSE);
+            motor_DriveBridge(motorDirection);
         }
-        else
+    }
+}
+
+/* Ramp target of the current mode: the speed setpoint or the open loop duty */
+static void motor_SetRampTarget(void)
+{
+    if (motorMode == MOTOR_MODE_SPEED)
+    {
+        Motor_Profile_SetTarget(&ramp, speedRefQ15);
+    }
+    else
+    {
+        Motor_Profile_SetTargetQ31(&ramp, motor_DutyQ16ToQ31(lastDutyQ16));
+    }
+}
+
+/* Drives the bridge in motorDirection and ramps up from standstill */
+static void motor_RampUp(void)
+{
+    motor_DriveBridge(motorDirection);
+    Motor_PI_Reset(&speedPI, 0);
+    Motor_Profile_Reset(&ramp, 0);
+    restartPending = false;
+    motorState = MOTOR_STARTING;
+    motor_SetRampTarget();
+}
+
+static bool motor_IsDriving(void)
+{
+    return (motorState == MOTOR_ON) || (motorState == MOTOR_STARTING);
+}
+
+static bool motor_FaultClear(void)
+{
+    uint32_t status;
+
+    if (!faulted)
+    {
+        return true;
+    }
+    status = motor_FaultStatusGet();
+#if MOTOR_FAULT_TRAVEL_LIMIT
+    if ((status & TCC_STATUS_FAULT0IN_Msk) != 0U)
+    {
+        // still past the travel window: disarm the travel fault so the motor
+        // can be driven back, the control loop rearms it once inside
+        motor_EventUserClear(EVENT_ID_USER_TCC1_EV0);
+        travelFaultArmed = false;
+    }
+#endif
+    (void)status;
+    if (!motor_FaultRelease())
+    {
+        return false;
+    }
+    faulted = false;
+    return true;
+}
+
+static void motor_Start(void)
+{
+    if (!motor_FaultClear())
+    {
+        return;
+    }
+    motor_LeavePosition();
+    switch (motorState)
+    {
+        case MOTOR_OFF:
+            motor_RampUp();
+            break;
+        case MOTOR_STOPPING:
+            if (motorDirection == bridgeDirection)
+            {
+                // still turning the right way, ramp back up from here
+                restartPending = false;
+                motorState = MOTOR_STARTING;
+                motor_SetRampTarget();
+            }
+            else
+            {
+                restartPending = true;
+            }
+            break;
+        case MOTOR_BRAKING:
+        case MOTOR_DEAD_TIME:
+            // the control loop ramps up once the motor is at rest
+            restartPending = true;
+            break;
+        default:
+            motor_SetRampTarget();
+            break;
+    }
+}
+
+static void motor_Stop(void)
+{
+    switch (motorState)
+    {
+        case MOTOR_ON:
+        case MOTOR_STARTING:
+            // the control loop brakes the motor once the ramp reaches zero
+            motorState = MOTOR_STOPPING;
+            restartPending = false;
+            if (motorMode == MOTOR_MODE_POSITION)
+            {
+                // decelerate along the move profile and hold where it ends
+                Motor_Profile_Halt(&ramp);
+            }
+            else
+            {
+                Motor_Profile_SetTarget(&ramp, 0);
+            }
+            break;
+        case MOTOR_STOPPING:
+        case MOTOR_BRAKING:
+            // cancel a pending reversal
+            restartPending = false;
+            break;
+        case MOTOR_DEAD_TIME:
+            motor_Off();
+            break;
+        default:
+            break;
+    }
+}
+
+static void motor_SetDutyQ16(uint32_t duty)
+{
+    motor_LeavePosition();
+    if (motorMode != MOTOR_MODE_OPEN_LOOP)
+    {
+        // continue the ramp from the duty the speed loop applied last
+        Motor_Profile_Reset(&ramp, motor_DutyQ15());
+        motorMode = MOTOR_MODE_OPEN_LOOP;
+    }
+    if (motor_IsDriving())
+    {
+        Motor_Profile_SetTargetQ31(&ramp, motor_DutyQ16ToQ31(duty));
+    }
+    lastDutyQ16 = duty;
+}
+
+static void motor_SetDutyDither(bool enable)
+{
+    dutyDither = enable;
+    ditherAcc = 0;
+    motor_ApplyDutyQ16(dutyQ16);
+}
+
+static void motor_SetSpeedRpm(uint32_t rpm)
+{
+    speedRefQ15 = (int16_t)((rpm * (uint32_t)MOTOR_Q15_MAX) / MOTOR_SPEED_BASE_RPM);
+    motor_LeavePosition();
+    if (motorMode != MOTOR_MODE_SPEED)
+    {
+        // bumpless transfer: the PI starts from the duty currently applied and
+        // the setpoint ramps from the measured speed
+        Motor_PI_Reset(&speedPI, motor_DutyQ15());
+        Motor_Profile_Reset(&ramp, motor_SpeedQ15());
+        motorMode = MOTOR_MODE_SPEED;
+    }
+    if (motor_IsDriving())
+    {
+        Motor_Profile_SetTarget(&ramp, speedRefQ15);
+    }
+}
+
+static void motor_SetRampLimits(uint32_t accel, uint32_t jerk)
+{
+    rampAccel = accel;
+    rampJerk = jerk;
+    if (motorMode != MOTOR_MODE_POSITION)
+    {
+        Motor_Profile_SetLimits(&ramp, accel, jerk, MOTOR_CTRL_LOOP_HZ);
+    }
+}
+
+static void motor_MoveTo(int32_t position)
+{
+    if (!motor_FaultClear())
+    {
+        return;
+    }
+    position = motor_PositionClamp(position);
+    if ((motorMode != MOTOR_MODE_POSITION) || (motorState == MOTOR_OFF))
+    {
+        // the move starts at rest from where the shaft is now, the speed loop
+        // becomes bipolar and the sign of its output picks the bridge direction
+        Motor_Profile_ResetQ31(&ramp, motor_PositionClamp(motor_PositionGet()) * 256);
+        Motor_Profile_SetRateLimits(&ramp, moveRateMax, moveRateStep);
+        Motor_PI_Init(&speedPI, speedPI.kp, speedPI.ki, speedPI.shift, -MOTOR_Q15_MAX, MOTOR_Q15_MAX);
+        motorMode = MOTOR_MODE_POSITION;
+    }
+    moveTarget = position;
+    Motor_Profile_SetTargetQ31(&ramp, position * 256);
+    settleTicks = 0;
+    restartPending = false;
+    motorState = MOTOR_ON;
+}
+
+static void motor_MoveBy(int32_t distance)
+{
+    // relative to the pending target while a move is running
+    int32_t base = ((motorMode == MOTOR_MODE_POSITION) && (motorState == MOTOR_ON)) ? moveTarget : motor_PositionGet();
+    int64_t position = (int64_t)base + distance;
+
+    motor_MoveTo((position > MOTOR_POS_RANGE) ? MOTOR_POS_RANGE :
+                 ((position < -MOTOR_POS_RANGE) ? -MOTOR_POS_RANGE : (int32_t)position));
+}
+
+static void motor_SetPosition(int32_t position)
+{
+    if (motorState == MOTOR_OFF)
+    {
+        QEI_PositionCountSet((uint32_t)(position * MOTOR_QEI_DIRECTION));
+    }
+}
+
+/* Reverses a running motor through ramp down, brake and dead time, the
+   control loop ramps it up the other way. Moves pick their own direction. */
+static bool motor_Reverse(void)
+{
+    if ((motorMode == MOTOR_MODE_POSITION) && (motorState != MOTOR_OFF))
+    {
+        return false;
+    }
+    motorDirection = (motorDirection == MOTOR_FORWARD) ? MOTOR_REVERSE : MOTOR_FORWARD;
+    if (motor_IsDriving())
+    {
+        motorState = MOTOR_STOPPING;
+        restartPending = true;
+        Motor_Profile_SetTarget(&ramp, 0);
+    }
+    else if ((motorState == MOTOR_STOPPING) && restartPending && (motorDirection == bridgeDirection))
+    {
+        // reversed back before the motor stopped, ramp up again from here
+        restartPending = false;
+        motorState = MOTOR_STARTING;
+        motor_SetRampTarget();
+    }
+    return true;
+}
+
+static void motor_Toggle(void)
+{
+    if ((motorState == MOTOR_OFF) || (!motor_IsDriving() && !restartPending))
+    {
+        // toggle direction each time motor is turned on, a stop in progress
+        // continues into the reversal
+        if (motor_Reverse())
         {
-            Motor_SetDirection(MOTOR_FORWARD);
+            motor_Start();
         }
-        Motor_Start();
     }
     else
     {
         // only toggle direction when turning on
-        Motor_Stop();
+        motor_Stop();
+    }
+}
+
+static void motor_CommandExecute(const motorCmd_t *p_cmd)
+{
+    switch ((motorCmdId_t)p_cmd->id)
+    {
+        case MOTOR_CMD_START:
+            motor_Start();
+            break;
+        case MOTOR_CMD_STOP:
+            motor_Stop();
+            break;
+        case MOTOR_CMD_TOGGLE:
+            motor_Toggle();
+            break;
+        case MOTOR_CMD_REVERSE:
+            // arg0 is the direction asked for, -1 to reverse whatever it is
+            if ((p_cmd->arg0 < 0) || ((motorDirection_t)p_cmd->arg0 != motorDirection))
+            {
+                (void)motor_Reverse();
+            }
+            break;
+        case MOTOR_CMD_DUTY:
+            motor_SetDutyQ16((uint32_t)p_cmd->arg0);
+            break;
+        case MOTOR_CMD_DITHER:
+            motor_SetDutyDither(p_cmd->param != 0U);
+            break;
+        case MOTOR_CMD_SPEED_RPM:
+            motor_SetSpeedRpm((uint32_t)p_cmd->arg0);
+            break;
+        case MOTOR_CMD_SPEED_GAINS:
+            Motor_PI_SetGains(&speedPI, (int16_t)p_cmd->arg0, (int16_t)p_cmd->arg1, p_cmd->param);
+            break;
+        case MOTOR_CMD_RAMP_LIMITS:
+            motor_SetRampLimits((uint32_t)p_cmd->arg0, (uint32_t)p_cmd->arg1);
+            break;
+        case MOTOR_CMD_MOVE_TO:
+            motor_MoveTo(p_cmd->arg0);
+            break;
+        case MOTOR_CMD_MOVE_BY:
+            motor_MoveBy(p_cmd->arg0);
+            break;
+        case MOTOR_CMD_SET_POSITION:
+            motor_SetPosition(p_cmd->arg0);
+            break;
+        case MOTOR_CMD_POSITION_LIMITS:
+            motor_SetPositionLimits(p_cmd->arg0, p_cmd->arg1);
+            break;
+        case MOTOR_CMD_MOVE_LIMITS:
+            moveRateMax = p_cmd->arg0;
+            moveRateStep = p_cmd->arg1;
+            if (motorMode == MOTOR_MODE_POSITION)
+            {
+                Motor_Profile_SetRateLimits(&ramp, moveRateMax, moveRateStep);
+            }
+            break;
+        case MOTOR_CMD_FAULT_CLEAR:
+            (void)motor_FaultClear();
+            break;
+        case MOTOR_CMD_RESET_STATS:
+            motor_StatsReset();
+            break;
+        case MOTOR_CMD_TELEMETRY:
+            stream.fields = p_cmd->param;
+            stream.decimation = (uint8_t)p_cmd->arg0;
+            streamDivider = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Position loop: profile position and rate feed a P position controller with
+   velocity feedforward, its output is the setpoint of the bipolar speed loop */
+static void motor_PositionTick(void)
+{
+    int32_t position = motor_PositionGet();
+    int32_t errorQ8;
+    int64_t command;
+    int16_t output;
+    motorState_t state;
+
+    (void)Motor_Profile_Update(&ramp);
+    errorQ8 = Motor_Profile_GetQ31(&ramp) - (motor_PositionClamp(position) * 256);
+
+    command = (((int64_t)ramp.rate * MOTOR_POS_FF_NUM) / MOTOR_POS_FF_DEN) +
+              (((int64_t)errorQ8 * MOTOR_POS_KP_DEFAULT) / 65536);
+    if (command > MOTOR_Q15_MAX)
+    {
+        command = MOTOR_Q15_MAX;
+    }
+    else if (command < -MOTOR_Q15_MAX)
+    {
+        command = -MOTOR_Q15_MAX;
+    }
+
+    output = Motor_PI_Update(&speedPI, (int16_t)command, motor_SpeedQ15Signed());
+    if (output >= 0)
+    {
+        motor_DriveBridge(MOTOR_FORWARD);
+        motor_ApplyDutyQ16((uint32_t)output << 1);
+    }
+    else
+    {
+        motor_DriveBridge(MOTOR_REVERSE);
+        motor_ApplyDutyQ16((uint32_t)(-output) << 1);
+    }
+
+    if (Motor_Profile_Done(&ramp) && (errorQ8 <= (MOTOR_POS_TOLERANCE * 256)) &&
+        (errorQ8 >= -(MOTOR_POS_TOLERANCE * 256)))
+    {
+        if (++settleTicks >= MOTOR_POS_SETTLE_TICKS)
+        {
+            state = motorState;
+            motor_Off();
+            if (eventCallback != NULL)
+            {
+                eventCallback((state == MOTOR_STOPPING) ? MOTOR_EVENT_MOVE_STOPPED : MOTOR_EVENT_MOVE_DONE,
+                              position, eventContext);
+            }
+        }
+    }
+    else
+    {
+        settleTicks = 0;
+    }
+}
+
+/* Ramp output in the unit of the loop it feeds: RPM Q16 in speed mode, duty
+   Q16 in open loop, position counts Q8 in position mode */
+static int32_t motor_ReferenceGet(void)
+{
+    int32_t valueQ31 = Motor_Profile_GetQ31(&ramp);
+
+    if (motorMode == MOTOR_MODE_SPEED)
+    {
+        return (int32_t)(((int64_t)valueQ31 * (2 * (int32_t)MOTOR_SPEED_BASE_RPM)) / 65536);
+    }
+    if (motorMode == MOTOR_MODE_OPEN_LOOP)
+    {
+        return (valueQ31 < 0) ? 0 : (int32_t)(((uint32_t)valueQ31 + 0x4000U) >> 15);
+    }
+    return valueQ31;
+}
+
+static void motor_StreamSample(void)
+{
+    motorTlmSample_t sample;
+
+    sample.index = tickIndex;
+    sample.dutyQ16 = (dutyQ16 >= MOTOR_DUTY_Q16_MAX) ? 0xFFFFU : (uint16_t)dutyQ16;
+    sample.stateMode = (uint8_t)((uint8_t)motorState | ((uint8_t)motorMode << 4));
+    sample.rpmQ16 = velocity.rpmQ16 * MOTOR_QEI_DIRECTION;
+    sample.reference = motor_ReferenceGet();
+    sample.position = motor_PositionGet();
+    if (Motor_Telemetry_StreamPush(&stream, &sample) && (eventCallback != NULL))
+    {
+        eventCallback(MOTOR_EVENT_TELEMETRY, sample.position, eventContext);
+    }
+}
+
+/* Called from the TCC1 period interrupt every MOTOR_CTRL_PWM_DIVIDER periods */
+void Motor_ControlTick(void)
+{
+    uint32_t startCycles = DWT->CYCCNT;
+    uint32_t cycles;
+    // sample the QEI registers back to back, velocity counter clears on read;
+    // the plib has no getter for the interval timer
+    int32_t counts = (int32_t)QEI_VelocityGet();
+    uint32_t timer = QEI_REGS->QEI_INTTMR;
+    uint32_t interval = QEI_PulseIntervalGet();
+    uint32_t elapsed = (startCycles - lastSampleCycles) / MOTOR_QEI_CYCLES_PER_TICK;
+    int16_t profileQ15;
+    int32_t profileQ31;
+    uint32_t duty;
+    uint32_t requests;
+    motorCmd_t cmd;
+
+    lastSampleCycles = startCycles;
+    (void)Motor_Velocity_Update(&velocity, counts, interval, timer, elapsed);
+
+#if MOTOR_FAULT_TRAVEL_LIMIT
+    if (!travelFaultArmed)
+    {
+        int32_t position = motor_PositionGet();
+
+        if ((position >= positionMin) && (position <= positionMax))
+        {
+            motor_EventUserSet(EVENT_ID_USER_TCC1_EV0, MOTOR_EVSYS_CH_TRAVEL);
+            travelFaultArmed = true;
+        }
+    }
+#endif
+
+    // all commands change the state here, in the control loop interrupt; the
+    // latency trace is marked first as some commands write the duty at once
+    while (Motor_Mailbox_Fetch(&commands, &cmd))
+    {
+        Motor_Latency_Executed();
+        motor_CommandExecute(&cmd);
+    }
+    // handled last so it wins over commands posted before it
+    requests = stopRequests;
+    if (requests != stopRequestsDone)
+    {
+        stopRequestsDone = requests;
+        Motor_Latency_Executed();
+        motor_Off();
+    }
+
+    if ((motorState != MOTOR_OFF) && (motorMode == MOTOR_MODE_POSITION))
+    {
+        motor_PositionTick();
+    }
+    else if (motorState == MOTOR_BRAKING)
+    {
+        if ((motor_SpeedQ15() <= MOTOR_BRAKE_STOP_Q15) || (++phaseTicks >= MOTOR_BRAKE_TICKS_MAX))
+        {
+            if (restartPending)
+            {
+                // no switch may conduct while the bridge changes direction
+                motorState = MOTOR_DEAD_TIME;
+                phaseTicks = 0;
+                motor_ApplyDutyQ16(0);
+            }
+            else
+            {
+                motor_Off();
+            }
+        }
+    }
+    else if (motorState == MOTOR_DEAD_TIME)
+    {
+        if (++phaseTicks >= MOTOR_DEAD_TIME_TICKS)
+        {
+            motor_RampUp();
+        }
+    }
+    else if (motorState != MOTOR_OFF)
+    {
+        // the profile output is the duty in open loop, the setpoint in speed mode
+        profileQ15 = Motor_Profile_Update(&ramp);
+        if (motorMode == MOTOR_MODE_SPEED)
+        {
+            // PI output is limited to 0..MOTOR_Q15_MAX
+            duty = (uint32_t)Motor_PI_Update(&speedPI, profileQ15, motor_SpeedQ15()) << 1;
+        }
+        else
+        {
+            // Q31 profile value rounded to Q16 keeps the sub-count resolution
+            profileQ31 = Motor_Profile_GetQ31(&ramp);
+            duty = (profileQ31 < 0) ? 0U : (((uint32_t)profileQ31 + 0x4000U) >> 15);
+        }
+
+        if ((motorState == MOTOR_STOPPING) && Motor_Profile_Done(&ramp))
+        {
+            motor_Brake();
+        }
+        else
+        {
+            if ((motorState == MOTOR_STARTING) && Motor_Profile_Done(&ramp))
+            {
+                motorState = MOTOR_ON;
+            }
+            motor_ApplyDutyQ16(duty);
+        }
+    }
+
+    if ((stream.decimation != 0U) && (++streamDivider >= stream.decimation))
+    {
+        streamDivider = 0;
+        motor_StreamSample();
+    }
+    tickIndex++;
+    Motor_Latency_TickEnd(dutyPending || dutyDither);
+
+    cycles = DWT->CYCCNT - startCycles;
+    ctrlStats.iterations++;
+    ctrlStats.execCycles = cycles;
+    if (cycles > ctrlStats.execCyclesMax)
+    {
+        ctrlStats.execCyclesMax = cycles;
+    }
+}
+
+/* The API below runs in the application task. It only posts commands, the
+   control loop applies them, so no path has to disable interrupts. Setters
+   return false when the command mailbox is full and the call was dropped. */
+static bool motor_Post(motorCmdId_t id, uint8_t param, int32_t arg0, int32_t arg1)
+{
+    motorCmd_t cmd;
+
+    cmd.id = (uint8_t)id;
+    cmd.param = param;
+    cmd.arg0 = arg0;
+    cmd.arg1 = arg1;
+    return Motor_Mailbox_Post(&commands, &cmd);
+}
+
+bool Motor_Start()
+{
+    return motor_Post(MOTOR_CMD_START, 0U, 0, 0);
+}
+
+bool Motor_Stop()
+{
+    return motor_Post(MOTOR_CMD_STOP, 0U, 0, 0);
+}
+
+/* Safe from any context, also from interrupts */
+void Motor_EmergencyStop(void)
+{
+    stopRequests++;
+}
+
+bool Motor_SetSpeed(uint32_t percentage)
+{
+    if (percentage > 100U)
+    {
+        percentage = 100U;
+    }
+    //SYS_CONSOLE_PRINT("Set new duty percentage %d\r\n", percentage);
+    return Motor_SetDutyQ16((percentage * MOTOR_DUTY_Q16_MAX) / 100U);
+}
+
+bool Motor_SetDutyQ16(uint32_t duty)
+{
+    if (duty > MOTOR_DUTY_Q16_MAX)
+    {
+        duty = MOTOR_DUTY_Q16_MAX;
+    }
+    return motor_Post(MOTOR_CMD_DUTY, 0U, (int32_t)duty, 0);
+}
+
+bool Motor_SetDutyDither(bool enable)
+{
+    return motor_Post(MOTOR_CMD_DITHER, enable ? 1U : 0U, 0, 0);
+}
+
+uint32_t Motor_GetDutyQ16(void)
+{
+    return dutyQ16;
+}
+
+bool Motor_SetSpeedRpm(uint32_t rpm)
+{
+    if (rpm > MOTOR_SPEED_BASE_RPM)
+    {
+        rpm = MOTOR_SPEED_BASE_RPM;
+    }
+    return motor_Post(MOTOR_CMD_SPEED_RPM, 0U, (int32_t)rpm, 0);
+}
+
+bool Motor_SetSpeedGains(int16_t kp, int16_t ki, uint8_t shift)
+{
+    return motor_Post(MOTOR_CMD_SPEED_GAINS, shift, kp, ki);
+}
+
+bool Motor_SetRampLimits(uint32_t accel, uint32_t jerk)
+{
+    return motor_Post(MOTOR_CMD_RAMP_LIMITS, 0U, (int32_t)accel, (int32_t)jerk);
+}
+
+bool Motor_MoveTo(int32_t position)
+{
+    return motor_Post(MOTOR_CMD_MOVE_TO, 0U, position, 0);
+}
+
+bool Motor_MoveBy(int32_t distance)
+{
+    return motor_Post(MOTOR_CMD_MOVE_BY, 0U, distance, 0);
+}
+
+/* Rejected while the motor runs, checked again when the command executes */
+bool Motor_SetPosition(int32_t position)
+{
+    if (motorState != MOTOR_OFF)
+    {
+        return false;
     }
-    //SYS_CONSOLE_PRINT("Toggling motor New State:%d New direction:%d\r\n", motorState, motorDirection);
-    
+    return motor_Post(MOTOR_CMD_SET_POSITION, 0U, position, 0);
+}
+
+int32_t Motor_GetPosition(void)
+{
+    return motor_PositionGet();
+}
+
+bool Motor_SetPositionLimits(int32_t minimum, int32_t maximum)
+{
+    return motor_Post(MOTOR_CMD_POSITION_LIMITS, 0U, minimum, maximum);
 }
+
+bool Motor_SetMoveLimits(uint32_t speedRpm, uint32_t accelRpmPerSec)
+{
+    // RPM -> Q8 counts per tick, RPM/s -> Q8 counts per tick^2
+    uint64_t rate = ((uint64_t)speedRpm * MOTOR_QEI_COUNTS_PER_REV * 256U) / (60U * MOTOR_CTRL_LOOP_HZ);
+    uint64_t step = ((uint64_t)accelRpmPerSec * MOTOR_QEI_COUNTS_PER_REV * 256U) /
+                    (60ULL * MOTOR_CTRL_LOOP_HZ * MOTOR_CTRL_LOOP_HZ);
+
+    return motor_Post(MOTOR_CMD_MOVE_LIMITS, 0U,
+                      (rate > (uint64_t)MOTOR_POS_RANGE) ? MOTOR_POS_RANGE : (int32_t)rate,
+                      (step > (uint64_t)MOTOR_POS_RANGE) ? MOTOR_POS_RANGE : (int32_t)step);
+}
+
+bool Motor_FaultClear(void)
+{
+    return motor_Post(MOTOR_CMD_FAULT_CLEAR, 0U, 0, 0);
+}
+
+bool Motor_IsFaulted(void)
+{
+    return faulted;
+}
+
+void Motor_EventCallbackRegister(MOTOR_EVENT_CALLBACK callback, uintptr_t context)
+{
+    eventContext = context;
+    eventCallback = callback;
+}
+
+bool Motor_Reverse(void)
+{
+    if ((motorMode == MOTOR_MODE_POSITION) && (motorState != MOTOR_OFF))
+    {
+        return false;
+    }
+    return motor_Post(MOTOR_CMD_REVERSE, 0U, -1, 0);
+}
+
+bool Motor_SetDirection(motorDirection_t direction)
+{
+    return motor_Post(MOTOR_CMD_REVERSE, 0U, (int32_t)direction, 0);
+}
+
+bool Motor_Toggle()
+{
+    return motor_Post(MOTOR_CMD_TOGGLE, 0U, 0, 0);
+}
+
+motorState_t Motor_GetState(void)
+{
+    return motorState;
+}
+
+int32_t Motor_GetVelocityRpm(void)
+{
+    return velocity.rpmQ16 / 65536;
+}
+
+int32_t Motor_GetVelocityRpmQ16(void)
+{
+    return velocity.rpmQ16;
+}
+
+/* Fills the status fields of a telemetry record, header fields are left to
+   the caller */
+void Motor_GetStatus(motorTlmRecord_t *p_rec)
+{
+    uint32_t status = motor_FaultStatusGet();
+    uint8_t flags = 0U;
+
+    p_rec->rpmQ16 = velocity.rpmQ16 * MOTOR_QEI_DIRECTION;
+    p_rec->dutyQ16 = (dutyQ16 >= MOTOR_DUTY_Q16_MAX) ? 0xFFFFU : (uint16_t)dutyQ16;
+    p_rec->state = (uint8_t)motorState;
+    p_rec->direction = (uint8_t)motorDirection;
+    p_rec->mode = (uint8_t)motorMode;
+    p_rec->position = motor_PositionGet();
+    if (faulted)
+    {
+        flags |= MOTOR_TLM_FLAG_FAULT;
+    }
+    if ((status & TCC_STATUS_FAULT0IN_Msk) != 0U)
+    {
+        flags |= MOTOR_TLM_FLAG_TRAVEL_INPUT;
+    }
+    if ((status & TCC_STATUS_FAULT1IN_Msk) != 0U)
+    {
+        flags |= MOTOR_TLM_FLAG_OBSTRUCTION;
+    }
+    if (dutyDither)
+    {
+        flags |= MOTOR_TLM_FLAG_DITHER;
+    }
+    if (restartPending)
+    {
+        flags |= MOTOR_TLM_FLAG_RESTART;
+    }
+    p_rec->flags = flags;
+}
+
+void Motor_GetControlStats(motorCtrlStats_t *p_stats)
+{
+    *p_stats = ctrlStats;
+    p_stats->commandsDropped = commands.dropped;
+}
+
+bool Motor_ResetControlStats(void)
+{
+    return motor_Post(MOTOR_CMD_RESET_STATS, 0U, 0, 0);
+}
+
+/* Samples every decimation control ticks, 0 stops the stream. The fields
+   only select what is packed, the ring keeps whole samples. */
+bool Motor_SetTelemetryStream(uint8_t decimation, uint8_t fields)
+{
+    return motor_Post(MOTOR_CMD_TELEMETRY, fields & MOTOR_TLM_FIELD_ALL, decimation, 0);
+}
+
+/* Consumer side of the stream, for the application task only */
+motorTlmStream_t *Motor_GetTelemetryStream(void)
+{
+    return &stream;
+}
+
 /* *****************************************************************************
  End of File
  */
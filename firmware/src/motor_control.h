@@ -52,11 +52,109 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include "configuration.h"
+#include "motor_pi.h"
+#include "motor_velocity.h"
+#include "motor_profile.h"
+#include "motor_mailbox.h"
+#include "motor_telemetry.h"
+#include "motor_latency.h"
 
+/* TCC1 counter clock: 128 MHz GCLK, no prescaler for the finest duty step */
+#define MOTOR_PWM_CLOCK_HZ              (128000000U)
+
+/* TCC1 PER value, NPWM runs PER + 1 counts per period (40 kHz) */
+#define MOTOR_PWM_PERIOD                (3199U)
+
+/* TCC1 interrupt priority, above the BLE stack and within the FreeRTOS syscall range */
+#define MOTOR_CTRL_IRQ_PRIORITY         (2U)
+
+/* Motor_ControlTick() runs once every MOTOR_CTRL_PWM_DIVIDER PWM periods */
+#define MOTOR_CTRL_PWM_DIVIDER          (80U)
+
+/* Nominal control loop rate, rounded (500 Hz with the defaults above) */
+#define MOTOR_CTRL_LOOP_HZ              ((MOTOR_PWM_CLOCK_HZ + (((MOTOR_PWM_PERIOD + 1U) * MOTOR_CTRL_PWM_DIVIDER) / 2U)) / \
+                                         ((MOTOR_PWM_PERIOD + 1U) * MOTOR_CTRL_PWM_DIVIDER))
+
+/* Expected CPU cycles between two control ticks */
+#define MOTOR_CTRL_TICK_CYCLES          ((configCPU_CLOCK_HZ / MOTOR_PWM_CLOCK_HZ) * (MOTOR_PWM_PERIOD + 1U) * MOTOR_CTRL_PWM_DIVIDER)
+
+/* The motor has 120 pulses per revolution, QEI counts 4 edges per pulse */
+#define MOTOR_QEI_COUNTS_PER_REV        (480U)
+
+/* CPU cycles per QEI interval timer tick */
+#define MOTOR_QEI_CYCLES_PER_TICK       (configCPU_CLOCK_HZ / MOTOR_QEI_TIMER_HZ)
+
+/* QEI count direction: 1 when MOTOR_FORWARD counts up, -1 otherwise */
+#define MOTOR_QEI_DIRECTION             (1)
+
+/* Speed that maps to 1.0 (Q15) in the speed loop */
+#define MOTOR_SPEED_BASE_RPM            (1000U)
+
+/* Default speed loop gains: Q15 mantissas scaled by 2^MOTOR_SPEED_SHIFT */
+#define MOTOR_SPEED_KP_DEFAULT          (16384)
+#define MOTOR_SPEED_KI_DEFAULT          (328)
+#define MOTOR_SPEED_SHIFT_DEFAULT       (1U)
+
+/* Duty cycle full scale for Motor_SetDutyQ16() (100 %) */
+#define MOTOR_DUTY_Q16_MAX              (65536U)
+
+/* Default ramp limits, Q15 full scale per second and per second^2:
+   full scale in 0.5 s, acceleration limit reached in 0.25 s */
+#define MOTOR_RAMP_ACCEL_DEFAULT        (65536U)
+#define MOTOR_RAMP_JERK_DEFAULT         (262144U)
+
+/* Position moves: default cruise speed (RPM) and acceleration (RPM/s) */
+#define MOTOR_MOVE_SPEED_DEFAULT        (300U)
+#define MOTOR_MOVE_ACCEL_DEFAULT        (1000U)
+
+/* Position loop gain: speed command (Q15 of the base speed) per count of
+   error, Q8. One revolution of error asks for 200 RPM. */
+#define MOTOR_POS_KP_DEFAULT            (3495)
+
+/* A move completes once the error stays within the tolerance (counts) for
+   the settle time (control ticks, 50 ms) */
+#define MOTOR_POS_TOLERANCE             (4)
+#define MOTOR_POS_SETTLE_TICKS          (MOTOR_CTRL_LOOP_HZ / 20U)
+
+/* Hardware fault routing through EVSYS into the TCC1 non-recoverable fault
+   inputs: the obstruction input (EIC EXTINT1) and the QEI compare output,
+   which is active outside the travel window, force the PWM outputs low
+   without waiting for an interrupt. Set to 0 to leave an input unrouted. */
+#define MOTOR_FAULT_OBSTRUCTION         (1)
+#define MOTOR_FAULT_TRAVEL_LIMIT        (1)
+#define MOTOR_EVSYS_CH_TRAVEL           (0U)
+#define MOTOR_EVSYS_CH_OBSTRUCTION      (1U)
+
+/* Overtravel allowed past the position limits before the hardware trips */
+#define MOTOR_POS_FAULT_MARGIN          (MOTOR_QEI_COUNTS_PER_REV / 2U)
+
+/* Positions are kept in Q8 counts inside the Q31 profile */
+#define MOTOR_POS_RANGE                 (0x7FFFFF)
+
+/* Profile rate (Q8 counts per tick) to speed (Q15 of the base speed) */
+#define MOTOR_POS_FF_NUM                ((int64_t)MOTOR_CTRL_LOOP_HZ * 60 * 32768)
+#define MOTOR_POS_FF_DEN                ((int64_t)256 * MOTOR_QEI_COUNTS_PER_REV * MOTOR_SPEED_BASE_RPM)
+
+/* Direction reversal: after ramping down the bridge brakes the motor until
+   it is below the stop speed (RPM) or the brake time (control ticks, 100 ms)
+   ran out, then all switches stay off for the dead time (10 ms) before the
+   bridge is driven the other way */
+#define MOTOR_BRAKE_STOP_RPM            (5)
+#define MOTOR_BRAKE_STOP_Q15            ((MOTOR_BRAKE_STOP_RPM * MOTOR_Q15_MAX) / (int32_t)MOTOR_SPEED_BASE_RPM)
+#define MOTOR_BRAKE_TICKS_MAX           (MOTOR_CTRL_LOOP_HZ / 10U)
+#define MOTOR_DEAD_TIME_TICKS           (MOTOR_CTRL_LOOP_HZ / 100U)
+
+/* Longest a telemetry stream sample waits before the consumer is woken,
+   control ticks (50 ms) */
+#define MOTOR_TLM_STREAM_LATENCY        (MOTOR_CTRL_LOOP_HZ / 20U)
 
 typedef enum {
     MOTOR_OFF = 0,
-    MOTOR_ON
+    MOTOR_ON,                   /* running at the requested duty or speed */
+    MOTOR_STOPPING,             /* ramping down, brakes at zero */
+    MOTOR_BRAKING,              /* bridge shorted until the motor is at rest */
+    MOTOR_DEAD_TIME,            /* bridge off before driving the other way */
+    MOTOR_STARTING              /* ramping up, turns MOTOR_ON at the target */
 } motorState_t;
 
 typedef enum {
@@ -64,16 +162,71 @@ typedef enum {
     MOTOR_REVERSE
 } motorDirection_t;
 
+typedef enum {
+    MOTOR_MODE_OPEN_LOOP = 0,   /* duty set directly by Motor_SetSpeed() */
+    MOTOR_MODE_SPEED,           /* duty set by the PI speed loop */
+    MOTOR_MODE_POSITION         /* position loop cascaded into the speed loop */
+} motorCtrlMode_t;
+
+typedef enum {
+    MOTOR_EVENT_MOVE_DONE = 0,  /* move reached its target position */
+    MOTOR_EVENT_MOVE_STOPPED,   /* move was cut short by Motor_Stop() */
+    MOTOR_EVENT_FAULT,          /* PWM cut by a hardware fault input */
+    MOTOR_EVENT_TELEMETRY       /* telemetry stream samples are waiting */
+} motorEvent_t;
+
+/* Called from the control loop interrupt */
+typedef void (*MOTOR_EVENT_CALLBACK)(motorEvent_t event, int32_t position, uintptr_t context);
+
+typedef struct {
+    uint32_t loopHz;            /* configured control loop rate */
+    uint32_t iterations;        /* number of Motor_ControlTick() calls */
+    uint32_t execCycles;        /* CPU cycles spent in the last iteration */
+    uint32_t execCyclesMax;     /* worst case CPU cycles per iteration */
+    uint32_t periodCycles;      /* expected CPU cycles between ticks */
+    uint32_t intervalMin;       /* shortest measured tick interval, CPU cycles */
+    uint32_t intervalMax;       /* longest measured tick interval, CPU cycles */
+    uint32_t jitterMax;         /* worst deviation from periodCycles, CPU cycles */
+    uint32_t commandsDropped;   /* API calls lost to a full command mailbox */
+} motorCtrlStats_t;
+
 /* Provide C++ Compatibility */
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void Motor_Start();
-void Motor_Stop();
-void Motor_SetSpeed(uint32_t percentage);
-void Motor_SetDirection(motorDirection_t direction);
-void Motor_Toggle();
+void Motor_Initialize(void);
+bool Motor_Start();
+bool Motor_Stop();
+void Motor_EmergencyStop(void);
+bool Motor_SetSpeed(uint32_t percentage);
+bool Motor_SetDutyQ16(uint32_t dutyQ16);
+bool Motor_SetDutyDither(bool enable);
+uint32_t Motor_GetDutyQ16(void);
+bool Motor_SetSpeedRpm(uint32_t rpm);
+bool Motor_SetSpeedGains(int16_t kp, int16_t ki, uint8_t shift);
+bool Motor_SetRampLimits(uint32_t accel, uint32_t jerk);
+bool Motor_SetDirection(motorDirection_t direction);
+bool Motor_Toggle();
+bool Motor_Reverse(void);
+motorState_t Motor_GetState(void);
+void Motor_ControlTick(void);
+bool Motor_MoveTo(int32_t position);
+bool Motor_MoveBy(int32_t distance);
+bool Motor_SetPosition(int32_t position);
+int32_t Motor_GetPosition(void);
+bool Motor_SetPositionLimits(int32_t minimum, int32_t maximum);
+bool Motor_SetMoveLimits(uint32_t speedRpm, uint32_t accelRpmPerSec);
+bool Motor_FaultClear(void);
+bool Motor_IsFaulted(void);
+void Motor_EventCallbackRegister(MOTOR_EVENT_CALLBACK callback, uintptr_t context);
+int32_t Motor_GetVelocityRpm(void);
+int32_t Motor_GetVelocityRpmQ16(void);
+void Motor_GetStatus(motorTlmRecord_t *p_rec);
+bool Motor_SetTelemetryStream(uint8_t decimation, uint8_t fields);
+motorTlmStream_t *Motor_GetTelemetryStream(void);
+void Motor_GetControlStats(motorCtrlStats_t *p_stats);
+bool Motor_ResetControlStats(void);
 
 /* Provide C++ Compatibility */
 #ifdef __cplusplus
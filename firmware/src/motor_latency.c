@@ -0,0 +1,223 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Command to Actuation Latency Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_latency.c
+
+  Summary:
+    This file contains the command latency timestamps and histograms.
+
+  Description:
+    This file contains the trace of the command in flight and the histogram
+    updates. The trace moves forward one stage at a time and the stage is
+    written after the stamps, so the control loop interrupt never works on a
+    trace the application task is still filling in.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "motor_latency.h"
+#include "definitions.h"
+
+
+#define MOTOR_LAT_CYCLES_PER_US         (configCPU_CLOCK_HZ / 1000000U)
+
+typedef enum {
+    MOTOR_LAT_IDLE = 0,
+    MOTOR_LAT_DEQUEUED,
+    MOTOR_LAT_HANDLED,
+    MOTOR_LAT_EXECUTED
+} motorLatStage_t;
+
+static volatile uint8_t traceStage = MOTOR_LAT_IDLE;
+static bool traceButton = false;
+static uint32_t receivedCycles;
+static uint32_t dequeuedCycles;
+static uint32_t handledCycles;
+static motorLatStats_t latStats;
+
+static void motor_lat_Add(motorLatSegment_t segment, uint32_t cycles)
+{
+    motorLatHistogram_t *p_hist = &latStats.segment[segment];
+    uint32_t us = cycles / MOTOR_LAT_CYCLES_PER_US;
+    uint32_t bin = 0;
+
+    if ((us >> MOTOR_LAT_BIN_SHIFT) != 0U)
+    {
+        // position of the highest set bit above the first bin
+        bin = 32U - (uint32_t)__CLZ(us >> MOTOR_LAT_BIN_SHIFT);
+        if (bin >= MOTOR_LAT_BINS)
+        {
+            bin = MOTOR_LAT_BINS - 1U;
+        }
+    }
+    p_hist->bins[bin]++;
+    p_hist->count++;
+    p_hist->sumUs += us;
+    if (us > p_hist->maxUs)
+    {
+        p_hist->maxUs = us;
+    }
+}
+
+/* A trace still open when a new one starts never reached the PWM */
+static void motor_lat_Open(void)
+{
+    if (traceStage != MOTOR_LAT_IDLE)
+    {
+        traceStage = MOTOR_LAT_IDLE;
+        latStats.overruns++;
+    }
+}
+
+/* Never returns 0, which the caller may use for "not traced" */
+uint32_t Motor_Latency_Stamp(void)
+{
+    return DWT->CYCCNT | 1U;
+}
+
+void Motor_Latency_Received(uint32_t receivedStamp)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    motor_lat_Open();
+    traceButton = false;
+    receivedCycles = receivedStamp;
+    dequeuedCycles = now;
+    traceStage = MOTOR_LAT_DEQUEUED;
+}
+
+void Motor_Latency_Handled(void)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    // only a write that came through the queue, others are not traced
+    if (traceStage == MOTOR_LAT_DEQUEUED)
+    {
+        handledCycles = now;
+        traceStage = MOTOR_LAT_HANDLED;
+    }
+}
+
+void Motor_Latency_Button(void)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    motor_lat_Open();
+    traceButton = true;
+    receivedCycles = now;
+    dequeuedCycles = now;
+    handledCycles = now;
+    traceStage = MOTOR_LAT_HANDLED;
+}
+
+void Motor_Latency_Executed(void)
+{
+    if (traceStage == MOTOR_LAT_HANDLED)
+    {
+        traceStage = MOTOR_LAT_EXECUTED;
+    }
+}
+
+void Motor_Latency_Actuated(void)
+{
+    uint32_t now;
+
+    if (traceStage != MOTOR_LAT_EXECUTED)
+    {
+        return;
+    }
+    now = DWT->CYCCNT;
+    if (traceButton)
+    {
+        motor_lat_Add(MOTOR_LAT_BUTTON_TOTAL, now - handledCycles);
+    }
+    else
+    {
+        motor_lat_Add(MOTOR_LAT_QUEUE, dequeuedCycles - receivedCycles);
+        motor_lat_Add(MOTOR_LAT_DISPATCH, handledCycles - dequeuedCycles);
+        motor_lat_Add(MOTOR_LAT_ACTUATE, now - handledCycles);
+        motor_lat_Add(MOTOR_LAT_BLE_TOTAL, now - receivedCycles);
+    }
+    traceStage = MOTOR_LAT_IDLE;
+}
+
+/* End of the control tick that ran the command, a duty still waiting for the
+   TCC buffer is written, and measured, on the next PWM period */
+void Motor_Latency_TickEnd(bool dutyPending)
+{
+    if ((traceStage == MOTOR_LAT_EXECUTED) && !dutyPending)
+    {
+        traceStage = MOTOR_LAT_IDLE;
+        latStats.unactuated++;
+    }
+}
+
+/* A sample taken while clearing may survive in one bin */
+void Motor_Latency_Reset(void)
+{
+    memset(&latStats, 0, sizeof(latStats));
+}
+
+const motorLatStats_t *Motor_Latency_GetStats(void)
+{
+    return &latStats;
+}
+
+uint16_t Motor_Latency_Encode(uint8_t segment, uint8_t *p_buf)
+{
+    const motorLatHistogram_t *p_hist = &latStats.segment[segment];
+    uint8_t *p_out = p_buf;
+    uint32_t value;
+    uint32_t i;
+
+    *p_out++ = segment;
+    value = p_hist->maxUs;
+    for (i = 0; i < 4U; i++)
+    {
+        *p_out++ = (uint8_t)(value >> (8U * i));
+    }
+    for (i = 0; i < MOTOR_LAT_BINS; i++)
+    {
+        value = (p_hist->bins[i] > UINT16_MAX) ? UINT16_MAX : p_hist->bins[i];
+        *p_out++ = (uint8_t)value;
+        *p_out++ = (uint8_t)(value >> 8);
+    }
+    return (uint16_t)(p_out - p_buf);
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,127 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+ Command to Actuation Latency interface
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_latency.h
+
+  Summary:
+    This header file provides the timestamps and histograms measuring how long
+    a command takes from its arrival to the PWM duty write.
+
+  Description:
+    Stamps are DWT cycle counts taken along the path of a command:
+
+      received   control write handed over by the BLE stack (APP_BleStackCb)
+      dequeued   message taken from the application queue (APP_Tasks)
+      handled    control write handler entered (APP_GattEvtHandler)
+      actuated   duty written to TCC1 after the control loop ran the command
+
+    A remote button press starts at the handled stage in its interrupt. One
+    command is traced at a time: a command arriving before the previous one
+    reached the PWM replaces it and counts as an overrun. A command the
+    control loop ran without writing a duty, a query with the motor off for
+    instance, is not measured.
+
+    Each segment has a histogram of power of two microsecond bins, bin 0
+    counts below 16 us, bin n from 2^(n+3) us, the last bin everything from
+    16.384 ms up. The encoded form read over BLE is little endian:
+
+      Offset  Size  Field
+       0      1     segment, motorLatSegment_t
+       1      4     largest latency, microseconds
+       5      24    MOTOR_LAT_BINS counts, 16 bit each, saturated
+ *******************************************************************************/
+#ifndef _MOTOR_LATENCY_H
+#define _MOTOR_LATENCY_H
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MOTOR_LAT_BINS                  (12U)
+/* the first bin ends at 2^MOTOR_LAT_BIN_SHIFT us */
+#define MOTOR_LAT_BIN_SHIFT             (4U)
+#define MOTOR_LAT_ENCODED_LEN           (5U + (2U * MOTOR_LAT_BINS))
+
+typedef enum {
+    MOTOR_LAT_QUEUE = 0,        /* received to dequeued, application queue wait */
+    MOTOR_LAT_DISPATCH,         /* dequeued to handled, event dispatch */
+    MOTOR_LAT_ACTUATE,          /* handled to actuated, handler, mailbox and control loop */
+    MOTOR_LAT_BLE_TOTAL,        /* received to actuated */
+    MOTOR_LAT_BUTTON_TOTAL,     /* button interrupt to actuated */
+    MOTOR_LAT_SEGMENTS
+} motorLatSegment_t;
+
+typedef struct {
+    uint32_t bins[MOTOR_LAT_BINS];
+    uint32_t count;
+    uint32_t maxUs;
+    uint64_t sumUs;
+} motorLatHistogram_t;
+
+typedef struct {
+    motorLatHistogram_t segment[MOTOR_LAT_SEGMENTS];
+    uint32_t overruns;          /* traces replaced before they reached the PWM */
+    uint32_t unactuated;        /* traced commands that wrote no duty */
+} motorLatStats_t;
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Application side, BLE stack callback and application task */
+uint32_t Motor_Latency_Stamp(void);
+void Motor_Latency_Received(uint32_t receivedStamp);
+void Motor_Latency_Handled(void);
+void Motor_Latency_Reset(void);
+const motorLatStats_t *Motor_Latency_GetStats(void);
+uint16_t Motor_Latency_Encode(uint8_t segment, uint8_t *p_buf);
+
+/* Interrupt side */
+void Motor_Latency_Button(void);
+void Motor_Latency_Executed(void);
+void Motor_Latency_Actuated(void);
+void Motor_Latency_TickEnd(bool dutyPending);
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MOTOR_LATENCY_H */
+
+/*******************************************************************************
+ End of File
+ */
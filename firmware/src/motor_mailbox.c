@@ -0,0 +1,96 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Motor Command Mailbox Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_mailbox.c
+
+  Summary:
+    This file contains the source code for the motor command mailbox.
+
+  Description:
+    This file contains the source code for the single producer, single
+    consumer command ring. The data memory barriers order the slot accesses
+    against the sequence counter updates.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include "motor_mailbox.h"
+#include "device.h"
+
+
+void Motor_Mailbox_Init(motorMailbox_t *p_box)
+{
+    p_box->head = 0;
+    p_box->tail = 0;
+    p_box->dropped = 0;
+}
+
+bool Motor_Mailbox_Post(motorMailbox_t *p_box, const motorCmd_t *p_cmd)
+{
+    uint32_t head = p_box->head;
+
+    // the counters wrap together, their difference is the fill level
+    if ((head - p_box->tail) >= MOTOR_MAILBOX_SIZE)
+    {
+        p_box->dropped++;
+        return false;
+    }
+    p_box->slot[head & (MOTOR_MAILBOX_SIZE - 1U)] = *p_cmd;
+    // the command must be complete before the consumer can see it
+    __DMB();
+    p_box->head = head + 1U;
+    return true;
+}
+
+bool Motor_Mailbox_Fetch(motorMailbox_t *p_box, motorCmd_t *p_cmd)
+{
+    uint32_t tail = p_box->tail;
+
+    if (tail == p_box->head)
+    {
+        return false;
+    }
+    // read the slot only after the head that published it
+    __DMB();
+    *p_cmd = p_box->slot[tail & (MOTOR_MAILBOX_SIZE - 1U)];
+    // the copy must be complete before the producer may reuse the slot
+    __DMB();
+    p_box->tail = tail + 1U;
+    return true;
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,91 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+ Motor Command Mailbox interface
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_mailbox.h
+
+  Summary:
+    This header file provides prototypes and definitions for the lock-free
+    command mailbox between the application and the motor control loop.
+
+  Description:
+    Single producer, single consumer ring of fixed size commands. The head
+    and tail are free running sequence counters, each written by one side
+    only, so neither side has to disable interrupts: the producer publishes
+    a command by advancing the head after the slot is written, the consumer
+    releases the slot by advancing the tail after it has been copied out.
+ *******************************************************************************/
+#ifndef _MOTOR_MAILBOX_H
+#define _MOTOR_MAILBOX_H
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Number of commands the mailbox holds, must be a power of two */
+#define MOTOR_MAILBOX_SIZE              (16U)
+
+typedef struct {
+    uint8_t id;                 /* command, defined by the consumer */
+    uint8_t param;              /* small argument */
+    int32_t arg0;               /* first argument */
+    int32_t arg1;               /* second argument */
+} motorCmd_t;
+
+typedef struct {
+    motorCmd_t slot[MOTOR_MAILBOX_SIZE];
+    volatile uint32_t head;     /* commands posted, written by the producer */
+    volatile uint32_t tail;     /* commands fetched, written by the consumer */
+    volatile uint32_t dropped;  /* posts refused while full, written by the producer */
+} motorMailbox_t;
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void Motor_Mailbox_Init(motorMailbox_t *p_box);
+bool Motor_Mailbox_Post(motorMailbox_t *p_box, const motorCmd_t *p_cmd);
+bool Motor_Mailbox_Fetch(motorMailbox_t *p_box, motorCmd_t *p_cmd);
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MOTOR_MAILBOX_H */
+
+/*******************************************************************************
+ End of File
+ */
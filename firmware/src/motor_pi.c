@@ -0,0 +1,127 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Fixed-point PI Controller Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_pi.c
+
+  Summary:
+    This file contains the source code for the fixed-point PI controller.
+
+  Description:
+    This file contains the source code for the Q15/Q31 PI controller used by
+    the motor speed loop. No floating point is used so it is safe to run from
+    interrupt context.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include "motor_pi.h"
+
+
+static int32_t motor_pi_SatQ31(int64_t value, int32_t min, int32_t max)
+{
+    if (value > max)
+    {
+        return max;
+    }
+    if (value < min)
+    {
+        return min;
+    }
+    return (int32_t)value;
+}
+
+void Motor_PI_Init(motorPI_t *p_pi, int16_t kp, int16_t ki, uint8_t shift, int16_t outMin, int16_t outMax)
+{
+    p_pi->outMin = outMin;
+    p_pi->outMax = outMax;
+    Motor_PI_SetGains(p_pi, kp, ki, shift);
+    Motor_PI_Reset(p_pi, 0);
+}
+
+void Motor_PI_SetGains(motorPI_t *p_pi, int16_t kp, int16_t ki, uint8_t shift)
+{
+    p_pi->kp = kp;
+    p_pi->ki = ki;
+    // keep (gain * error) << (shift + 1) inside 64 bits with margin
+    p_pi->shift = (shift > 15U) ? 15U : shift;
+}
+
+void Motor_PI_Reset(motorPI_t *p_pi, int16_t output)
+{
+    // preloading the integrator with the current output gives a bumpless start
+    if (output < p_pi->outMin)
+    {
+        output = p_pi->outMin;
+    }
+    else if (output > p_pi->outMax)
+    {
+        output = p_pi->outMax;
+    }
+    p_pi->integrator = (int32_t)output * 65536;
+}
+
+int16_t Motor_PI_Update(motorPI_t *p_pi, int16_t reference, int16_t measurement)
+{
+    int32_t intMin = (int32_t)p_pi->outMin * 65536;
+    int32_t intMax = (int32_t)p_pi->outMax * 65536;
+    int32_t error = (int32_t)reference - (int32_t)measurement;
+    int64_t proportional;
+    int64_t integral;
+    int32_t output;
+
+    if (error > MOTOR_Q15_MAX)
+    {
+        error = MOTOR_Q15_MAX;
+    }
+    else if (error < MOTOR_Q15_MIN)
+    {
+        error = MOTOR_Q15_MIN;
+    }
+
+    // Q15 * Q15 = Q30, one extra shift brings the products to Q31
+    proportional = ((int64_t)p_pi->kp * error) * ((int64_t)1 << (p_pi->shift + 1U));
+    integral = ((int64_t)p_pi->ki * error) * ((int64_t)1 << (p_pi->shift + 1U));
+
+    // anti-windup: the integrator never leaves the output range
+    p_pi->integrator = motor_pi_SatQ31((int64_t)p_pi->integrator + integral, intMin, intMax);
+
+    output = motor_pi_SatQ31((int64_t)p_pi->integrator + proportional, intMin, intMax);
+
+    return (int16_t)(output >> 16);
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,86 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+ Fixed-point PI Controller interface
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_pi.h
+
+  Summary:
+    This header file provides prototypes and definitions for the fixed-point
+    PI controller used by the motor speed loop.
+
+  Description:
+    Reference, measurement and output are Q15 values normalized to a base
+    quantity chosen by the caller. Gains are Q15 mantissas scaled by 2^shift,
+    the integrator is kept in Q31. The integrator is clamped to the output
+    limits so it cannot wind up while the output is saturated.
+ *******************************************************************************/
+#ifndef _MOTOR_PI_H
+#define _MOTOR_PI_H
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MOTOR_Q15_MAX       (32767)
+#define MOTOR_Q15_MIN       (-32768)
+
+typedef struct {
+    int32_t integrator;     /* Integral term, Q31 */
+    int16_t kp;             /* Proportional gain mantissa, Q15 */
+    int16_t ki;             /* Integral gain per sample mantissa, Q15 */
+    uint8_t shift;          /* Both gains are multiplied by 2^shift */
+    int16_t outMin;         /* Lower output limit, Q15 */
+    int16_t outMax;         /* Upper output limit, Q15 */
+} motorPI_t;
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void Motor_PI_Init(motorPI_t *p_pi, int16_t kp, int16_t ki, uint8_t shift, int16_t outMin, int16_t outMax);
+void Motor_PI_SetGains(motorPI_t *p_pi, int16_t kp, int16_t ki, uint8_t shift);
+void Motor_PI_Reset(motorPI_t *p_pi, int16_t output);
+int16_t Motor_PI_Update(motorPI_t *p_pi, int16_t reference, int16_t measurement);
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MOTOR_PI_H */
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,219 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+
+/*******************************************************************************
+  Jerk-limited Profile Generator Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_profile.c
+
+  Summary:
+    This file contains the source code for the S-curve profile generator.
+
+  Description:
+    This file contains the source code for the incremental jerk-limited
+    profile generator. Motor_Profile_Update() is called from the control loop
+    interrupt and uses integer arithmetic only.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include "motor_profile.h"
+
+
+static int32_t motor_prof_Abs(int32_t value)
+{
+    return (value < 0) ? -value : value;
+}
+
+/* distance covered while ramping the rate down to zero:
+   r + (r - j) + ... = r^2 / 2j + r / 2 */
+static int64_t motor_prof_Braking(const motorProfile_t *p_prof, int32_t rateAbs)
+{
+    return (((int64_t)rateAbs * rateAbs) / (2 * (int64_t)p_prof->jerkMax)) + (rateAbs / 2);
+}
+
+static int32_t motor_prof_Limit(uint64_t value)
+{
+    if (value > (uint64_t)INT32_MAX)
+    {
+        return INT32_MAX;
+    }
+    if (value == 0U)
+    {
+        return 1;
+    }
+    return (int32_t)value;
+}
+
+void Motor_Profile_Init(motorProfile_t *p_prof, uint32_t accel, uint32_t jerk, uint32_t tickHz)
+{
+    Motor_Profile_SetLimits(p_prof, accel, jerk, tickHz);
+    Motor_Profile_Reset(p_prof, 0);
+}
+
+void Motor_Profile_SetLimits(motorProfile_t *p_prof, uint32_t accel, uint32_t jerk, uint32_t tickHz)
+{
+    // Q15 per second -> Q31 per tick, Q15 per second^2 -> Q31 per tick^2
+    p_prof->accelMax = motor_prof_Limit(((uint64_t)accel * 65536U) / tickHz);
+    p_prof->jerkMax = motor_prof_Limit(((uint64_t)jerk * 65536U) / ((uint64_t)tickHz * tickHz));
+    if (p_prof->jerkMax > p_prof->accelMax)
+    {
+        // a jerk above the acceleration limit per tick is a trapezoidal profile
+        p_prof->jerkMax = p_prof->accelMax;
+    }
+}
+
+/* Limits already in output units per tick, for callers that do not use Q15 */
+void Motor_Profile_SetRateLimits(motorProfile_t *p_prof, int32_t rateMax, int32_t rateStep)
+{
+    p_prof->accelMax = (rateMax > 0) ? rateMax : 1;
+    p_prof->jerkMax = (rateStep > 0) ? rateStep : 1;
+    if (p_prof->jerkMax > p_prof->accelMax)
+    {
+        p_prof->jerkMax = p_prof->accelMax;
+    }
+}
+
+void Motor_Profile_SetTarget(motorProfile_t *p_prof, int16_t target)
+{
+    p_prof->target = (int32_t)target * 65536;
+}
+
+/* Full resolution target, for callers that need more than Q15 */
+void Motor_Profile_SetTargetQ31(motorProfile_t *p_prof, int32_t target)
+{
+    p_prof->target = target;
+}
+
+void Motor_Profile_Reset(motorProfile_t *p_prof, int16_t value)
+{
+    Motor_Profile_ResetQ31(p_prof, (int32_t)value * 65536);
+}
+
+void Motor_Profile_ResetQ31(motorProfile_t *p_prof, int32_t value)
+{
+    p_prof->value = value;
+    p_prof->target = value;
+    p_prof->rate = 0;
+}
+
+/* Retarget to the point where the current rate can be ramped down to zero */
+void Motor_Profile_Halt(motorProfile_t *p_prof)
+{
+    int32_t rate = p_prof->rate;
+    int64_t target;
+
+    if (rate >= 0)
+    {
+        target = (int64_t)p_prof->value + motor_prof_Braking(p_prof, rate);
+    }
+    else
+    {
+        target = (int64_t)p_prof->value - motor_prof_Braking(p_prof, -rate);
+    }
+    p_prof->target = (target > INT32_MAX) ? INT32_MAX : ((target < INT32_MIN) ? INT32_MIN : (int32_t)target);
+}
+
+int16_t Motor_Profile_Update(motorProfile_t *p_prof)
+{
+    int64_t distance = (int64_t)p_prof->target - p_prof->value;
+    int32_t rate = p_prof->rate;
+    int32_t rateAbs = motor_prof_Abs(rate);
+    int32_t error;
+    int32_t desired;
+    int64_t braking;
+
+    // full scale swings do not fit an int32, the rate never needs more
+    error = (distance > INT32_MAX) ? INT32_MAX : ((distance < -INT32_MAX) ? -INT32_MAX : (int32_t)distance);
+
+    if ((motor_prof_Abs(error) <= p_prof->jerkMax) && (rateAbs <= p_prof->jerkMax))
+    {
+        // within one step of the target with the rate nearly zero
+        p_prof->value = p_prof->target;
+        p_prof->rate = 0;
+        return (int16_t)(p_prof->value >> 16);
+    }
+
+    braking = motor_prof_Braking(p_prof, rateAbs);
+
+    if (((error > 0) && (rate > 0)) || ((error < 0) && (rate < 0)))
+    {
+        // moving towards the target, start slowing down once it is in reach
+        desired = ((int64_t)motor_prof_Abs(error) - rateAbs <= braking) ? 0 :
+                  ((error > 0) ? p_prof->accelMax : -p_prof->accelMax);
+    }
+    else
+    {
+        desired = (error > 0) ? p_prof->accelMax : -p_prof->accelMax;
+    }
+
+    if (desired > rate + p_prof->jerkMax)
+    {
+        rate += p_prof->jerkMax;
+    }
+    else if (desired < rate - p_prof->jerkMax)
+    {
+        rate -= p_prof->jerkMax;
+    }
+    else
+    {
+        rate = desired;
+    }
+
+    if (((error > 0) && (rate >= error)) || ((error < 0) && (rate <= error)))
+    {
+        // never step past the target
+        p_prof->value = p_prof->target;
+        p_prof->rate = 0;
+    }
+    else
+    {
+        p_prof->rate = rate;
+        p_prof->value += rate;
+    }
+    return (int16_t)(p_prof->value >> 16);
+}
+
+int32_t Motor_Profile_GetQ31(const motorProfile_t *p_prof)
+{
+    return p_prof->value;
+}
+
+bool Motor_Profile_Done(const motorProfile_t *p_prof)
+{
+    return (p_prof->value == p_prof->target) && (p_prof->rate == 0);
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,96 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+
+/*******************************************************************************
+ Jerk-limited Profile Generator interface
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_profile.h
+
+  Summary:
+    This header file provides prototypes and definitions for the S-curve
+    profile generator used for motor start, stop and speed changes.
+
+  Description:
+    The generator moves its output towards a target one control tick at a
+    time. The rate of change is limited to the acceleration limit and the
+    rate itself changes by at most the jerk limit per tick, giving an S-shaped
+    transition. The output is a Q15 value normalized by the caller, so it can
+    drive either the PWM duty directly or the speed loop setpoint.
+
+    Internally the output is kept in Q31, the rate in Q31 per tick and the
+    jerk in Q31 per tick squared. Limits are converted once when they are set
+    so Motor_Profile_Update() only uses integer arithmetic.
+ *******************************************************************************/
+#ifndef _MOTOR_PROFILE_H
+#define _MOTOR_PROFILE_H
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+    int32_t value;              /* current output, Q31 */
+    int32_t rate;               /* current rate of change, Q31 per tick */
+    int32_t target;             /* requested output, Q31 */
+    int32_t accelMax;           /* rate limit, Q31 per tick */
+    int32_t jerkMax;            /* rate change limit, Q31 per tick^2 */
+} motorProfile_t;
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* accel: full scale per second in Q15, jerk: full scale per second^2 in Q15 */
+void Motor_Profile_Init(motorProfile_t *p_prof, uint32_t accel, uint32_t jerk, uint32_t tickHz);
+void Motor_Profile_SetLimits(motorProfile_t *p_prof, uint32_t accel, uint32_t jerk, uint32_t tickHz);
+void Motor_Profile_SetRateLimits(motorProfile_t *p_prof, int32_t rateMax, int32_t rateStep);
+void Motor_Profile_SetTarget(motorProfile_t *p_prof, int16_t target);
+void Motor_Profile_SetTargetQ31(motorProfile_t *p_prof, int32_t target);
+void Motor_Profile_Reset(motorProfile_t *p_prof, int16_t value);
+void Motor_Profile_ResetQ31(motorProfile_t *p_prof, int32_t value);
+void Motor_Profile_Halt(motorProfile_t *p_prof);
+int16_t Motor_Profile_Update(motorProfile_t *p_prof);
+int32_t Motor_Profile_GetQ31(const motorProfile_t *p_prof);
+bool Motor_Profile_Done(const motorProfile_t *p_prof);
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MOTOR_PROFILE_H */
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,241 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Motor Command Protocol Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_proto.c
+
+  Summary:
+    This file contains the parser of the TLV command protocol.
+
+  Description:
+    This file contains the frame check, the table dispatch and the
+    acknowledgement builder. See motor_proto.h for the layouts.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "motor_proto.h"
+
+
+/* Checks that the commands exactly fill the frame */
+static bool motor_proto_FrameValid(const uint8_t *p_frame, uint16_t len)
+{
+    uint16_t offset = MOTOR_PROTO_HEADER_LEN;
+    uint8_t count = 0;
+
+    while ((uint16_t)(len - offset) >= MOTOR_PROTO_TLV_HEADER_LEN)
+    {
+        offset += MOTOR_PROTO_TLV_HEADER_LEN + p_frame[offset + 2U];
+        if (offset > len)
+        {
+            return false;
+        }
+        count++;
+    }
+    return (offset == len) && (count == p_frame[1]);
+}
+
+static const motorProtoEntry_t *motor_proto_Find(const motorProtoEntry_t *p_table, uint8_t tableLen, uint8_t id)
+{
+    uint8_t i;
+
+    for (i = 0; i < tableLen; i++)
+    {
+        if (p_table[i].id == id)
+        {
+            return &p_table[i];
+        }
+    }
+    return NULL;
+}
+
+/* Counts the commands missing before seq, returns true on a gap */
+static bool motor_proto_SeqCheck(motorProtoSeq_t *p_seq, uint8_t seq)
+{
+    bool gap = false;
+
+    if (p_seq->valid && (seq != p_seq->next))
+    {
+        p_seq->lost += (uint8_t)(seq - p_seq->next);
+        gap = true;
+    }
+    p_seq->valid = true;
+    p_seq->next = (uint8_t)(seq + 1U);
+    p_seq->received++;
+    return gap;
+}
+
+uint16_t Motor_Proto_Process(const motorProtoEntry_t *p_table, uint8_t tableLen,
+                             const uint8_t *p_frame, uint16_t len, motorProtoSeq_t *p_seq,
+                             uint8_t *p_ack, uint16_t ackMax)
+{
+    bool gap = false;
+    const motorProtoEntry_t *p_entry;
+    const uint8_t *p_cmd;
+    uint8_t reply[MOTOR_PROTO_REPLY_MAX];
+    uint8_t replyLen;
+    uint8_t valueLen;
+    motorProtoStatus_t status;
+    uint16_t offset = MOTOR_PROTO_HEADER_LEN;
+    uint16_t ackLen = MOTOR_PROTO_ACK_HEADER_LEN;
+
+    if (ackMax < MOTOR_PROTO_ACK_HEADER_LEN)
+    {
+        return 0;
+    }
+    p_ack[0] = MOTOR_PROTO_VERSION;
+    p_ack[1] = MOTOR_PROTO_ACK;
+    p_ack[2] = (uint8_t)MOTOR_PROTO_OK;
+    p_ack[3] = 0;
+
+    if ((len < MOTOR_PROTO_HEADER_LEN) || (p_frame[0] != MOTOR_PROTO_VERSION))
+    {
+        p_ack[2] = (uint8_t)MOTOR_PROTO_BAD_VERSION;
+        return ackLen;
+    }
+    if (!motor_proto_FrameValid(p_frame, len))
+    {
+        p_ack[2] = (uint8_t)MOTOR_PROTO_BAD_FRAME;
+        return ackLen;
+    }
+
+    while (offset < len)
+    {
+        p_cmd = &p_frame[offset];
+        valueLen = p_cmd[2];
+        replyLen = 0;
+        if ((p_seq != NULL) && motor_proto_SeqCheck(p_seq, p_cmd[1]))
+        {
+            gap = true;
+        }
+        p_entry = motor_proto_Find(p_table, tableLen, p_cmd[0]);
+        if (p_entry == NULL)
+        {
+            status = MOTOR_PROTO_UNKNOWN;
+        }
+        else if ((valueLen < p_entry->minLen) || (valueLen > p_entry->maxLen))
+        {
+            status = MOTOR_PROTO_BAD_LENGTH;
+        }
+        else
+        {
+            status = p_entry->handler(&p_cmd[MOTOR_PROTO_TLV_HEADER_LEN], valueLen, reply, &replyLen);
+            if (replyLen > MOTOR_PROTO_REPLY_MAX)
+            {
+                replyLen = MOTOR_PROTO_REPLY_MAX;
+            }
+        }
+        offset += MOTOR_PROTO_TLV_HEADER_LEN + valueLen;
+
+        if (p_ack[2] != (uint8_t)MOTOR_PROTO_OK)
+        {
+            // notification already full, keep running the commands
+            continue;
+        }
+        if ((ackLen + MOTOR_PROTO_ACK_ENTRY_LEN + replyLen) > ackMax)
+        {
+            p_ack[2] = (uint8_t)MOTOR_PROTO_ACK_FULL;
+            continue;
+        }
+        p_ack[ackLen++] = p_cmd[0];
+        p_ack[ackLen++] = p_cmd[1];
+        p_ack[ackLen++] = (uint8_t)status;
+        p_ack[ackLen++] = replyLen;
+        memcpy(&p_ack[ackLen], reply, replyLen);
+        ackLen += replyLen;
+        p_ack[3]++;
+    }
+    if (gap && (p_ack[2] == (uint8_t)MOTOR_PROTO_OK))
+    {
+        p_ack[2] = (uint8_t)MOTOR_PROTO_SEQ_GAP;
+    }
+    return ackLen;
+}
+
+/* True if the frame or any acknowledged command did not complete normally */
+bool Motor_Proto_AckFailed(const uint8_t *p_ack, uint16_t len)
+{
+    uint16_t offset = MOTOR_PROTO_ACK_HEADER_LEN;
+
+    if ((len < MOTOR_PROTO_ACK_HEADER_LEN) || (p_ack[2] != (uint8_t)MOTOR_PROTO_OK))
+    {
+        return true;
+    }
+    while ((uint16_t)(len - offset) >= MOTOR_PROTO_ACK_ENTRY_LEN)
+    {
+        if (p_ack[offset + 2U] != (uint8_t)MOTOR_PROTO_OK)
+        {
+            return true;
+        }
+        offset += MOTOR_PROTO_ACK_ENTRY_LEN + p_ack[offset + 3U];
+    }
+    return false;
+}
+
+/* Little endian value of 1 to 4 bytes, zero extended */
+uint32_t Motor_Proto_GetU32(const uint8_t *p_value, uint8_t len)
+{
+    uint32_t value = 0;
+
+    if (len > 4U)
+    {
+        len = 4U;
+    }
+    while (len > 0U)
+    {
+        len--;
+        value = (value << 8) | p_value[len];
+    }
+    return value;
+}
+
+/* Little endian value of 1 to 4 bytes, sign extended */
+int32_t Motor_Proto_GetI32(const uint8_t *p_value, uint8_t len)
+{
+    uint32_t value = Motor_Proto_GetU32(p_value, len);
+    uint8_t bits;
+
+    if ((len == 0U) || (len >= 4U))
+    {
+        return (int32_t)value;
+    }
+    bits = (uint8_t)(32U - (8U * len));
+    // move the sign bit to the top and divide back down
+    return (int32_t)(value << bits) / (int32_t)(1UL << bits);
+}
+
+/* *****************************************************************************
+ End of File
+ */
@@ -0,0 +1,178 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+ Motor Command Protocol interface
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_proto.h
+
+  Summary:
+    This header file provides the framing and the table driven parser of the
+    TLV command protocol written to control characteristic 0.
+
+  Description:
+    One write carries a frame with any number of commands:
+
+      Offset  Size  Field
+       0      1     version, MOTOR_PROTO_VERSION
+       1      1     number of commands
+       2      ...   commands, each:
+                      0  1  command id, MOTOR_PROTO_CMD_*
+                      1  1  sequence number chosen by the sender
+                      2  1  value length
+                      3  ...value, little endian
+
+    The whole frame is checked before anything runs: a wrong version, a
+    command running past the end of the write, bytes left over or a command
+    count that does not match rejects the frame and no command is executed.
+    Commands then run in order. An unknown id or a value length outside the
+    table limits only fails that command.
+
+    Every frame is answered with one notification on control characteristic
+    1:
+
+      Offset  Size  Field
+       0      1     version, MOTOR_PROTO_VERSION
+       1      1     type, MOTOR_PROTO_ACK
+       2      1     frame status, motorProtoStatus_t
+       3      1     number of acknowledgements
+       4      ...   acknowledgements in command order, each:
+                      0  1  command id
+                      1  1  sequence number of the command
+                      2  1  status, motorProtoStatus_t
+                      3  1  reply length
+                      4  ...reply
+
+    When the notification is full the remaining commands still run but are
+    not acknowledged and the frame status is MOTOR_PROTO_ACK_FULL.
+
+    Frames can also be written without response for streaming setpoints.
+    Nothing tells the sender when such a write is lost, so on that path the
+    sequence numbers must count up by one per command across frames. The
+    receiver keeps a motorProtoSeq_t per sender, counts the commands
+    skipped in the numbering and marks the frame following a gap with
+    MOTOR_PROTO_SEQ_GAP. Any sequence value is accepted after a gap, so a
+    sender that restarts its numbering costs one reported gap.
+
+    The parser only uses explicit byte shifts and knows nothing about the
+    motor, the command table is passed in, so it builds and runs on a host.
+    Writes of exactly 4 bytes keep the older fixed layout and never reach
+    the parser; a frame is either 2 bytes or at least 5.
+ *******************************************************************************/
+#ifndef _MOTOR_PROTO_H
+#define _MOTOR_PROTO_H
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MOTOR_PROTO_VERSION             (1U)
+#define MOTOR_PROTO_HEADER_LEN          (2U)
+#define MOTOR_PROTO_TLV_HEADER_LEN      (3U)
+#define MOTOR_PROTO_ACK                 (0x81U)     /* notification type, next to MOTOR_TLM_STREAM */
+#define MOTOR_PROTO_ACK_HEADER_LEN      (4U)
+#define MOTOR_PROTO_ACK_ENTRY_LEN       (4U)
+#define MOTOR_PROTO_REPLY_MAX           (32U)       /* largest reply of one command */
+
+/* Command ids, the value layout follows each id */
+#define MOTOR_PROTO_CMD_RUN             (0x10U)     /* uint8: 0 stop, 1 start, 2 toggle */
+#define MOTOR_PROTO_CMD_SPEED           (0x11U)     /* uint8: open loop speed, 0-100 % */
+#define MOTOR_PROTO_CMD_DUTY            (0x12U)     /* uint16/32: duty Q16, 0xFFFF or 0x10000 is 100 % */
+#define MOTOR_PROTO_CMD_DITHER          (0x13U)     /* uint8: duty dithering off/on */
+#define MOTOR_PROTO_CMD_MOVE_TO         (0x14U)     /* int8-32: absolute target, QEI counts */
+#define MOTOR_PROTO_CMD_MOVE_BY         (0x15U)     /* int8-32: relative distance, QEI counts */
+#define MOTOR_PROTO_CMD_SET_POSITION    (0x16U)     /* int8-32: current position, QEI counts, motor off */
+#define MOTOR_PROTO_CMD_STREAM          (0x17U)     /* uint8 decimation (0 off), uint8 MOTOR_TLM_FIELD_* (0 all) */
+#define MOTOR_PROTO_CMD_SPEED_RPM       (0x18U)     /* uint8-32: closed loop speed, RPM */
+#define MOTOR_PROTO_CMD_DIRECTION       (0x19U)     /* uint8: motorDirection_t */
+#define MOTOR_PROTO_CMD_PROFILE         (0x1AU)     /* uint32 speed RPM, uint32 acceleration RPM/s of moves */
+#define MOTOR_PROTO_CMD_FAULT_CLEAR     (0x1BU)     /* no value */
+#define MOTOR_PROTO_CMD_QUERY           (0x20U)     /* no value, replies with a telemetry record */
+#define MOTOR_PROTO_CMD_LATENCY         (0x21U)     /* uint8 motorLatSegment_t, replies with its histogram, see motor_latency.h */
+
+/* MOTOR_PROTO_CMD_LATENCY value clearing all histograms, no reply */
+#define MOTOR_PROTO_LATENCY_RESET       (0xFFU)
+
+typedef enum {
+    MOTOR_PROTO_OK = 0,
+    MOTOR_PROTO_BAD_VERSION,        /* frame: unknown protocol version */
+    MOTOR_PROTO_BAD_FRAME,          /* frame: lengths or command count do not add up */
+    MOTOR_PROTO_ACK_FULL,           /* frame: later commands ran but are not acknowledged */
+    MOTOR_PROTO_UNKNOWN,            /* command: id not in the table */
+    MOTOR_PROTO_BAD_LENGTH,         /* command: value length outside the table limits */
+    MOTOR_PROTO_BAD_VALUE,          /* command: value out of range */
+    MOTOR_PROTO_REJECTED,           /* command: not possible in the current state */
+    MOTOR_PROTO_BUSY,               /* command: could not be queued, try again */
+    MOTOR_PROTO_SEQ_GAP             /* frame: commands before this frame were lost */
+} motorProtoStatus_t;
+
+/* Sequence tracking of one sender on the write without response path */
+typedef struct {
+    bool valid;                     /* a command was seen since the reset */
+    uint8_t next;                   /* sequence number expected next */
+    uint32_t received;              /* commands received */
+    uint32_t lost;                  /* commands missing from the numbering */
+} motorProtoSeq_t;
+
+/* Runs one command, may write up to MOTOR_PROTO_REPLY_MAX bytes of reply */
+typedef motorProtoStatus_t (*MOTOR_PROTO_HANDLER)(const uint8_t *p_value, uint8_t len,
+                                                  uint8_t *p_reply, uint8_t *p_replyLen);
+
+typedef struct {
+    uint8_t id;
+    uint8_t minLen;                 /* shortest accepted value */
+    uint8_t maxLen;                 /* longest accepted value */
+    MOTOR_PROTO_HANDLER handler;
+} motorProtoEntry_t;
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint16_t Motor_Proto_Process(const motorProtoEntry_t *p_table, uint8_t tableLen,
+                             const uint8_t *p_frame, uint16_t len, motorProtoSeq_t *p_seq,
+                             uint8_t *p_ack, uint16_t ackMax);
+bool Motor_Proto_AckFailed(const uint8_t *p_ack, uint16_t len);
+uint32_t Motor_Proto_GetU32(const uint8_t *p_value, uint8_t len);
+int32_t Motor_Proto_GetI32(const uint8_t *p_value, uint8_t len);
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MOTOR_PROTO_H */
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,328 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Motor Telemetry Record Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_telemetry.c
+
+  Summary:
+    This file contains the source code for the binary telemetry record.
+
+  Description:
+    This file contains the encoders used by the firmware, the matching
+    decoders and the sample ring feeding the stream packets. See
+    motor_telemetry.h for the layouts.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <string.h>
+#include "motor_telemetry.h"
+#if defined(__arm__)
+#include "device.h"
+#else
+/* host builds only decode, nothing to order */
+#define __DMB()
+#endif
+
+
+static uint8_t *motor_tlm_PutU16(uint8_t *p_buf, uint16_t value)
+{
+    p_buf[0] = (uint8_t)value;
+    p_buf[1] = (uint8_t)(value >> 8);
+    return p_buf + 2;
+}
+
+static uint8_t *motor_tlm_PutU32(uint8_t *p_buf, uint32_t value)
+{
+    p_buf[0] = (uint8_t)value;
+    p_buf[1] = (uint8_t)(value >> 8);
+    p_buf[2] = (uint8_t)(value >> 16);
+    p_buf[3] = (uint8_t)(value >> 24);
+    return p_buf + 4;
+}
+
+static uint16_t motor_tlm_GetU16(const uint8_t *p_buf)
+{
+    return (uint16_t)(p_buf[0] | ((uint16_t)p_buf[1] << 8));
+}
+
+static uint32_t motor_tlm_GetU32(const uint8_t *p_buf)
+{
+    return (uint32_t)p_buf[0] | ((uint32_t)p_buf[1] << 8) |
+           ((uint32_t)p_buf[2] << 16) | ((uint32_t)p_buf[3] << 24);
+}
+
+uint16_t Motor_Telemetry_Encode(const motorTlmRecord_t *p_rec, uint8_t *p_buf)
+{
+    uint8_t *p_out = p_buf;
+
+    *p_out++ = MOTOR_TLM_VERSION;
+    *p_out++ = p_rec->type;
+    p_out = motor_tlm_PutU16(p_out, p_rec->sequence);
+    p_out = motor_tlm_PutU32(p_out, p_rec->timestamp);
+    p_out = motor_tlm_PutU32(p_out, (uint32_t)p_rec->rpmQ16);
+    p_out = motor_tlm_PutU16(p_out, p_rec->dutyQ16);
+    *p_out++ = p_rec->state;
+    *p_out++ = p_rec->direction;
+    *p_out++ = p_rec->mode;
+    *p_out++ = p_rec->flags;
+    p_out = motor_tlm_PutU32(p_out, (uint32_t)p_rec->position);
+    return (uint16_t)(p_out - p_buf);
+}
+
+bool Motor_Telemetry_Decode(const uint8_t *p_buf, uint16_t len, motorTlmRecord_t *p_rec)
+{
+    if ((len < MOTOR_TLM_RECORD_LEN) || (p_buf[0] != MOTOR_TLM_VERSION))
+    {
+        return false;
+    }
+    p_rec->version = p_buf[0];
+    p_rec->type = p_buf[1];
+    p_rec->sequence = motor_tlm_GetU16(&p_buf[2]);
+    p_rec->timestamp = motor_tlm_GetU32(&p_buf[4]);
+    p_rec->rpmQ16 = (int32_t)motor_tlm_GetU32(&p_buf[8]);
+    p_rec->dutyQ16 = motor_tlm_GetU16(&p_buf[12]);
+    p_rec->state = p_buf[14];
+    p_rec->direction = p_buf[15];
+    p_rec->mode = p_buf[16];
+    p_rec->flags = p_buf[17];
+    p_rec->position = (int32_t)motor_tlm_GetU32(&p_buf[18]);
+    return true;
+}
+
+uint8_t Motor_Telemetry_SampleLen(uint8_t fields)
+{
+    uint8_t len = 0U;
+
+    len += ((fields & MOTOR_TLM_FIELD_SPEED) != 0U) ? 4U : 0U;
+    len += ((fields & MOTOR_TLM_FIELD_REFERENCE) != 0U) ? 4U : 0U;
+    len += ((fields & MOTOR_TLM_FIELD_DUTY) != 0U) ? 2U : 0U;
+    len += ((fields & MOTOR_TLM_FIELD_POSITION) != 0U) ? 4U : 0U;
+    len += ((fields & MOTOR_TLM_FIELD_STATE) != 0U) ? 1U : 0U;
+    return len;
+}
+
+void Motor_Telemetry_StreamInit(motorTlmStream_t *p_stream, uint16_t latency)
+{
+    p_stream->head = 0;
+    p_stream->tail = 0;
+    p_stream->wakeups = 0;
+    p_stream->wakeupsSeen = 0;
+    p_stream->dropped = 0;
+    p_stream->latency = latency;
+    p_stream->decimation = 0;
+    p_stream->fields = MOTOR_TLM_FIELD_ALL;
+}
+
+/* Returns true when the consumer has to be woken */
+bool Motor_Telemetry_StreamPush(motorTlmStream_t *p_stream, const motorTlmSample_t *p_sample)
+{
+    uint32_t head = p_stream->head;
+    uint32_t tail = p_stream->tail;
+
+    if ((head - tail) >= MOTOR_TLM_STREAM_SIZE)
+    {
+        p_stream->dropped++;
+    }
+    else
+    {
+        p_stream->sample[head & (MOTOR_TLM_STREAM_SIZE - 1U)] = *p_sample;
+        // the sample must be complete before the consumer can see it
+        __DMB();
+        p_stream->head = ++head;
+    }
+    // one wake-up at a time, the consumer acknowledges it before draining
+    if ((p_stream->wakeups != p_stream->wakeupsSeen) || (head == tail))
+    {
+        return false;
+    }
+    if (((head - tail) < MOTOR_TLM_STREAM_BATCH) &&
+        ((uint16_t)(p_sample->index - p_stream->sample[tail & (MOTOR_TLM_STREAM_SIZE - 1U)].index) < p_stream->latency))
+    {
+        return false;
+    }
+    p_stream->wakeups++;
+    return true;
+}
+
+void Motor_Telemetry_StreamAck(motorTlmStream_t *p_stream)
+{
+    p_stream->wakeupsSeen = p_stream->wakeups;
+}
+
+/* Packs consecutive samples from the oldest on, they stay in the ring until
+   released so a notification that cannot be sent is retried */
+uint16_t Motor_Telemetry_StreamPack(motorTlmStream_t *p_stream, uint8_t *p_buf, uint16_t maxLen,
+                                    uint16_t sequence, uint16_t loopHz, uint8_t *p_count)
+{
+    uint8_t fields = p_stream->fields;
+    uint8_t decimation = p_stream->decimation;
+    uint16_t sampleLen = Motor_Telemetry_SampleLen(fields);
+    uint32_t tail = p_stream->tail;
+    uint32_t head = p_stream->head;
+    const motorTlmSample_t *p_sample;
+    uint8_t *p_out = p_buf + MOTOR_TLM_STREAM_HEADER_LEN;
+    uint16_t index = 0;
+    uint8_t count = 0;
+
+    *p_count = 0;
+    if ((sampleLen == 0U) || (maxLen < (MOTOR_TLM_STREAM_HEADER_LEN + sampleLen)))
+    {
+        return 0;
+    }
+    // read the samples only after the head that published them
+    __DMB();
+    while ((tail != head) && ((uint16_t)(p_out - p_buf) + sampleLen <= maxLen) && (count < UINT8_MAX))
+    {
+        p_sample = &p_stream->sample[tail & (MOTOR_TLM_STREAM_SIZE - 1U)];
+        if (count == 0U)
+        {
+            index = p_sample->index;
+        }
+        else if (p_sample->index != (uint16_t)(index + (count * decimation)))
+        {
+            // dropped samples or a new decimation start the next packet
+            break;
+        }
+        if ((fields & MOTOR_TLM_FIELD_SPEED) != 0U)
+        {
+            p_out = motor_tlm_PutU32(p_out, (uint32_t)p_sample->rpmQ16);
+        }
+        if ((fields & MOTOR_TLM_FIELD_REFERENCE) != 0U)
+        {
+            p_out = motor_tlm_PutU32(p_out, (uint32_t)p_sample->reference);
+        }
+        if ((fields & MOTOR_TLM_FIELD_DUTY) != 0U)
+        {
+            p_out = motor_tlm_PutU16(p_out, p_sample->dutyQ16);
+        }
+        if ((fields & MOTOR_TLM_FIELD_POSITION) != 0U)
+        {
+            p_out = motor_tlm_PutU32(p_out, (uint32_t)p_sample->position);
+        }
+        if ((fields & MOTOR_TLM_FIELD_STATE) != 0U)
+        {
+            *p_out++ = p_sample->stateMode;
+        }
+        count++;
+        tail++;
+    }
+    if (count == 0U)
+    {
+        return 0;
+    }
+    p_buf[0] = MOTOR_TLM_VERSION;
+    p_buf[1] = MOTOR_TLM_STREAM;
+    (void)motor_tlm_PutU16(&p_buf[2], sequence);
+    (void)motor_tlm_PutU16(&p_buf[4], index);
+    (void)motor_tlm_PutU16(&p_buf[6], loopHz);
+    p_buf[8] = decimation;
+    p_buf[9] = fields;
+    p_buf[10] = count;
+    *p_count = count;
+    return (uint16_t)(p_out - p_buf);
+}
+
+void Motor_Telemetry_StreamRelease(motorTlmStream_t *p_stream, uint8_t count)
+{
+    // the samples must be read before the producer may reuse their slots
+    __DMB();
+    p_stream->tail += count;
+}
+
+void Motor_Telemetry_StreamFlush(motorTlmStream_t *p_stream)
+{
+    p_stream->tail = p_stream->head;
+}
+
+/* Returns the number of samples decoded, fields not present are zero */
+uint8_t Motor_Telemetry_DecodeStream(const uint8_t *p_buf, uint16_t len, motorTlmStreamHeader_t *p_hdr,
+                                     motorTlmSample_t *p_samples, uint8_t maxSamples)
+{
+    const uint8_t *p_in = p_buf + MOTOR_TLM_STREAM_HEADER_LEN;
+    uint8_t sampleLen;
+    uint8_t i;
+
+    if ((len < MOTOR_TLM_STREAM_HEADER_LEN) || (p_buf[0] != MOTOR_TLM_VERSION) || (p_buf[1] != MOTOR_TLM_STREAM))
+    {
+        return 0;
+    }
+    p_hdr->version = p_buf[0];
+    p_hdr->type = p_buf[1];
+    p_hdr->sequence = motor_tlm_GetU16(&p_buf[2]);
+    p_hdr->index = motor_tlm_GetU16(&p_buf[4]);
+    p_hdr->loopHz = motor_tlm_GetU16(&p_buf[6]);
+    p_hdr->decimation = p_buf[8];
+    p_hdr->fields = p_buf[9];
+    p_hdr->count = p_buf[10];
+    sampleLen = Motor_Telemetry_SampleLen(p_hdr->fields);
+    if ((sampleLen == 0U) || ((len - MOTOR_TLM_STREAM_HEADER_LEN) < ((uint16_t)p_hdr->count * sampleLen)))
+    {
+        return 0;
+    }
+    for (i = 0U; (i < p_hdr->count) && (i < maxSamples); i++)
+    {
+        (void)memset(&p_samples[i], 0, sizeof(p_samples[i]));
+        p_samples[i].index = (uint16_t)(p_hdr->index + (i * p_hdr->decimation));
+        if ((p_hdr->fields & MOTOR_TLM_FIELD_SPEED) != 0U)
+        {
+            p_samples[i].rpmQ16 = (int32_t)motor_tlm_GetU32(p_in);
+            p_in += 4;
+        }
+        if ((p_hdr->fields & MOTOR_TLM_FIELD_REFERENCE) != 0U)
+        {
+            p_samples[i].reference = (int32_t)motor_tlm_GetU32(p_in);
+            p_in += 4;
+        }
+        if ((p_hdr->fields & MOTOR_TLM_FIELD_DUTY) != 0U)
+        {
+            p_samples[i].dutyQ16 = motor_tlm_GetU16(p_in);
+            p_in += 2;
+        }
+        if ((p_hdr->fields & MOTOR_TLM_FIELD_POSITION) != 0U)
+        {
+            p_samples[i].position = (int32_t)motor_tlm_GetU32(p_in);
+            p_in += 4;
+        }
+        if ((p_hdr->fields & MOTOR_TLM_FIELD_STATE) != 0U)
+        {
+            p_samples[i].stateMode = *p_in++;
+        }
+    }
+    return i;
+}
+
+/* *****************************************************************************
+ End of File
+ */
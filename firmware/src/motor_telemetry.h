@@ -0,0 +1,195 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+ Motor Telemetry Record interface
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_telemetry.h
+
+  Summary:
+    This header file provides the binary telemetry record sent on the CTRL
+    service characteristic 1 and the functions to encode and decode it.
+
+  Description:
+    Every notification on characteristic 1 carries one record. All fields are
+    little endian and unaligned:
+
+      Offset  Size  Field
+       0      1     version, MOTOR_TLM_VERSION
+       1      1     type, motorTlmType_t: 0 periodic sample, else an event
+       2      2     sequence number, increments per record and wraps
+       4      4     timestamp, milliseconds since start
+       8      4     speed, signed RPM in Q16, positive is forward
+      12      2     duty, Q16, 0xFFFF is 100 %
+      14      1     state, motorState_t
+      15      1     direction, motorDirection_t
+      16      1     control mode, motorCtrlMode_t
+      17      1     flags, MOTOR_TLM_FLAG_*
+      18      4     position, signed QEI counts
+
+    New fields are only ever appended: a decoder accepts records longer than
+    it knows and ignores the tail. The version changes when the meaning or
+    position of an existing field changes. The functions only use explicit
+    byte shifts, so the same source decodes records on a host.
+
+    A stream packet (type MOTOR_TLM_STREAM) carries consecutive control loop
+    samples instead, as many as fit in the notification:
+
+      Offset  Size  Field
+       0      1     version, MOTOR_TLM_VERSION
+       1      1     type, MOTOR_TLM_STREAM
+       2      2     sequence number, shared with the records
+       4      2     control loop iteration of the first sample, wraps
+       6      2     control loop rate, Hz
+       8      1     decimation, iterations between samples
+       9      1     fields present in each sample, MOTOR_TLM_FIELD_*
+      10      1     number of samples
+      11      ...   samples, the selected fields in the order of their bits
+
+    Samples in one packet are always consecutive. A gap in the iteration
+    count between packets means samples were dropped.
+ *******************************************************************************/
+#ifndef _MOTOR_TELEMETRY_H
+#define _MOTOR_TELEMETRY_H
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MOTOR_TLM_VERSION               (1U)
+#define MOTOR_TLM_RECORD_LEN            (22U)
+
+#define MOTOR_TLM_FLAG_FAULT            (0x01U)     /* PWM cut by a fault, cleared by the next start */
+#define MOTOR_TLM_FLAG_TRAVEL_INPUT     (0x02U)     /* shaft outside the travel window */
+#define MOTOR_TLM_FLAG_OBSTRUCTION      (0x04U)     /* obstruction input active */
+#define MOTOR_TLM_FLAG_DITHER           (0x08U)     /* duty dithering enabled */
+#define MOTOR_TLM_FLAG_RESTART          (0x10U)     /* restart queued after braking */
+
+/* Stream packets, samples are kept in a ring of MOTOR_TLM_STREAM_SIZE
+   (a power of two); the consumer is woken once MOTOR_TLM_STREAM_BATCH are
+   waiting or the oldest one waited for the stream latency */
+#define MOTOR_TLM_STREAM                (0x80U)
+#define MOTOR_TLM_STREAM_HEADER_LEN     (11U)
+#define MOTOR_TLM_STREAM_SIZE           (128U)
+#define MOTOR_TLM_STREAM_BATCH          (8U)
+
+#define MOTOR_TLM_FIELD_SPEED           (0x01U)     /* int32, RPM Q16 */
+#define MOTOR_TLM_FIELD_REFERENCE       (0x02U)     /* int32, ramp output: RPM Q16, duty Q16 or counts Q8 by mode */
+#define MOTOR_TLM_FIELD_DUTY            (0x04U)     /* uint16, Q16, 0xFFFF is 100 % */
+#define MOTOR_TLM_FIELD_POSITION        (0x08U)     /* int32, QEI counts */
+#define MOTOR_TLM_FIELD_STATE           (0x10U)     /* uint8, state | control mode << 4 */
+#define MOTOR_TLM_FIELD_ALL             (0x1FU)
+
+typedef enum {
+    MOTOR_TLM_SAMPLE = 0,           /* periodic status */
+    MOTOR_TLM_EVENT_MOVE_DONE,      /* move reached its target position */
+    MOTOR_TLM_EVENT_MOVE_STOPPED,   /* move was cut short */
+    MOTOR_TLM_EVENT_FAULT,          /* PWM cut by a hardware fault input */
+    MOTOR_TLM_EVENT_OBSTRUCTION,    /* obstruction button pressed */
+    MOTOR_TLM_EVENT_REMOTE_TOGGLE   /* toggle requested by the remote button */
+} motorTlmType_t;
+
+typedef struct {
+    uint8_t version;
+    uint8_t type;
+    uint16_t sequence;
+    uint32_t timestamp;
+    int32_t rpmQ16;
+    uint16_t dutyQ16;
+    uint8_t state;
+    uint8_t direction;
+    uint8_t mode;
+    uint8_t flags;
+    int32_t position;
+} motorTlmRecord_t;
+
+typedef struct {
+    uint16_t index;             /* control loop iteration */
+    uint16_t dutyQ16;
+    uint8_t stateMode;          /* state | control mode << 4 */
+    int32_t rpmQ16;
+    int32_t reference;
+    int32_t position;
+} motorTlmSample_t;
+
+typedef struct {
+    uint8_t version;
+    uint8_t type;
+    uint16_t sequence;
+    uint16_t index;             /* iteration of the first sample */
+    uint16_t loopHz;
+    uint8_t decimation;
+    uint8_t fields;
+    uint8_t count;
+} motorTlmStreamHeader_t;
+
+/* Single producer (control loop), single consumer (application task) */
+typedef struct {
+    motorTlmSample_t sample[MOTOR_TLM_STREAM_SIZE];
+    volatile uint32_t head;         /* samples pushed, written by the producer */
+    volatile uint32_t tail;         /* samples sent, written by the consumer */
+    volatile uint32_t wakeups;      /* consumer wake-ups, written by the producer */
+    volatile uint32_t wakeupsSeen;  /* wake-ups handled, written by the consumer */
+    volatile uint32_t dropped;      /* samples lost while full, written by the producer */
+    uint16_t latency;               /* iterations a sample may wait for a wake-up */
+    volatile uint8_t decimation;    /* iterations per sample, 0 stops the stream, written by the producer */
+    volatile uint8_t fields;        /* MOTOR_TLM_FIELD_* sampled, written by the producer */
+} motorTlmStream_t;
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint16_t Motor_Telemetry_Encode(const motorTlmRecord_t *p_rec, uint8_t *p_buf);
+bool Motor_Telemetry_Decode(const uint8_t *p_buf, uint16_t len, motorTlmRecord_t *p_rec);
+uint8_t Motor_Telemetry_SampleLen(uint8_t fields);
+void Motor_Telemetry_StreamInit(motorTlmStream_t *p_stream, uint16_t latency);
+bool Motor_Telemetry_StreamPush(motorTlmStream_t *p_stream, const motorTlmSample_t *p_sample);
+void Motor_Telemetry_StreamAck(motorTlmStream_t *p_stream);
+uint16_t Motor_Telemetry_StreamPack(motorTlmStream_t *p_stream, uint8_t *p_buf, uint16_t maxLen,
+                                    uint16_t sequence, uint16_t loopHz, uint8_t *p_count);
+void Motor_Telemetry_StreamRelease(motorTlmStream_t *p_stream, uint8_t count);
+void Motor_Telemetry_StreamFlush(motorTlmStream_t *p_stream);
+uint8_t Motor_Telemetry_DecodeStream(const uint8_t *p_buf, uint16_t len, motorTlmStreamHeader_t *p_hdr,
+                                     motorTlmSample_t *p_samples, uint8_t maxSamples);
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MOTOR_TELEMETRY_H */
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,129 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+
+/*******************************************************************************
+  M/T Velocity Estimator Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_velocity.c
+
+  Summary:
+    This file contains the source code for the QEI based velocity estimator.
+
+  Description:
+    This file contains the source code for the M/T velocity estimator. All
+    arithmetic is integer so it can run from the control loop interrupt.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include "motor_velocity.h"
+
+
+/* RPM Q16 for m edges spanning t timer ticks */
+static int32_t motor_vel_RpmQ16(const motorVelocity_t *p_vel, uint32_t edges, uint32_t ticks)
+{
+    // edges per minute at one tick per edge first, keeps the product in 64 bits
+    uint64_t rpmQ16 = ((uint64_t)edges * 60ULL * MOTOR_QEI_TIMER_HZ) / p_vel->countsPerRev;
+
+    rpmQ16 = (rpmQ16 * 65536ULL) / ticks;
+
+    if (rpmQ16 > (uint64_t)INT32_MAX)
+    {
+        rpmQ16 = (uint64_t)INT32_MAX;
+    }
+    return (int32_t)rpmQ16;
+}
+
+void Motor_Velocity_Init(motorVelocity_t *p_vel, uint32_t countsPerRev)
+{
+    p_vel->rpmQ16 = 0;
+    p_vel->lastTimer = 0;
+    p_vel->countsPerRev = countsPerRev;
+    p_vel->method = MOTOR_VEL_METHOD_T;
+    p_vel->reverse = false;
+}
+
+int32_t Motor_Velocity_Update(motorVelocity_t *p_vel, int32_t counts, uint32_t interval,
+                              uint32_t timer, uint32_t elapsed)
+{
+    uint32_t edges = (counts < 0) ? (uint32_t)(-counts) : (uint32_t)counts;
+    uint32_t period;
+    uint32_t span;
+    int32_t rpmQ16;
+
+    if (counts != 0)
+    {
+        p_vel->reverse = (counts < 0);
+    }
+
+    if (edges >= (uint32_t)MOTOR_VEL_MT_ENTER_COUNTS)
+    {
+        p_vel->method = MOTOR_VEL_METHOD_MT;
+    }
+    else if (edges < (uint32_t)MOTOR_VEL_MT_EXIT_COUNTS)
+    {
+        p_vel->method = MOTOR_VEL_METHOD_T;
+    }
+
+    // the edges counted span the sample time, minus the time since the last
+    // edge now, plus the time since the last edge at the previous sample
+    span = elapsed + p_vel->lastTimer - timer;
+    p_vel->lastTimer = timer;
+
+    if ((p_vel->method == MOTOR_VEL_METHOD_MT) && (edges != 0U) &&
+        (timer < elapsed) && (span != 0U) && (span < (2U * elapsed)))
+    {
+        rpmQ16 = motor_vel_RpmQ16(p_vel, edges, span);
+    }
+    else
+    {
+        // no edge for longer than the last period means the shaft is slowing
+        // down, the open interval is an upper bound on the speed
+        period = (timer > interval) ? timer : interval;
+        if ((period == 0U) || (period >= MOTOR_VEL_STOP_TICKS))
+        {
+            rpmQ16 = 0;
+        }
+        else
+        {
+            rpmQ16 = motor_vel_RpmQ16(p_vel, 1U, period);
+        }
+    }
+
+    p_vel->rpmQ16 = p_vel->reverse ? -rpmQ16 : rpmQ16;
+    return p_vel->rpmQ16;
+}
+
+/* *****************************************************************************
+ End of File
+ */
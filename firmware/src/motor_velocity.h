@@ -0,0 +1,103 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+
+/*******************************************************************************
+ M/T Velocity Estimator interface
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    motor_velocity.h
+
+  Summary:
+    This header file provides prototypes and definitions for the QEI based
+    M/T velocity estimator.
+
+  Description:
+    The estimator combines the QEI velocity counter (M, edges per sample) with
+    the QEI interval timer (T, time between edges). At high speed the M/T
+    method divides the edges counted by the exact time spanned by them, at low
+    speed the T method uses the period of the last edge. The method is chosen
+    per sample with hysteresis. The result is a signed speed in RPM, Q16.
+ *******************************************************************************/
+#ifndef _MOTOR_VELOCITY_H
+#define _MOTOR_VELOCITY_H
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdint.h>
+#include <stdbool.h>
+
+/* QEI interval timer clock, must match the QEI clock selected in MCC */
+#define MOTOR_QEI_TIMER_HZ              (64000000U)
+
+/* Edges per sample needed to enter / stay in the M/T method */
+#define MOTOR_VEL_MT_ENTER_COUNTS       (4)
+#define MOTOR_VEL_MT_EXIT_COUNTS        (2)
+
+/* No edge for this long means the shaft has stopped (200 ms) */
+#define MOTOR_VEL_STOP_TICKS            (MOTOR_QEI_TIMER_HZ / 5U)
+
+typedef enum {
+    MOTOR_VEL_METHOD_T = 0,     /* period of the last edge, low speed */
+    MOTOR_VEL_METHOD_MT         /* edges over the time they span, high speed */
+} motorVelMethod_t;
+
+typedef struct {
+    int32_t rpmQ16;             /* last estimate, RPM Q16 */
+    uint32_t lastTimer;         /* interval timer at the previous sample */
+    uint32_t countsPerRev;      /* QEI edges per mechanical revolution */
+    motorVelMethod_t method;    /* method used for the last estimate */
+    bool reverse;               /* direction of the last edge seen */
+} motorVelocity_t;
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void Motor_Velocity_Init(motorVelocity_t *p_vel, uint32_t countsPerRev);
+
+/* counts:   QEI velocity counter read this sample (edges since the last one)
+   interval: QEI pulse interval hold register, period of the last full edge
+   timer:    QEI interval timer, time since the last edge
+   elapsed:  time since the previous sample, QEI timer ticks */
+int32_t Motor_Velocity_Update(motorVelocity_t *p_vel, int32_t counts, uint32_t interval,
+                              uint32_t timer, uint32_t elapsed);
+
+/* Provide C++ Compatibility */
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MOTOR_VELOCITY_H */
+
+/*******************************************************************************
+ End of File
+ */
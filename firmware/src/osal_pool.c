@@ -0,0 +1,216 @@
+/*******************************************************************************
+  Operating System Abstraction Layer Fixed Block Pools
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    osal_pool.c
+
+  Summary:
+    OSAL size class pool allocator implementation
+
+  Description:
+    Each size class is one static array of blocks. Free blocks are chained
+    through their first word, so allocating and freeing is a list pop or push
+    under a critical section that holds off the other tasks. The class of a
+    freed block follows from its address.
+*******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include "osal/osal_freertos.h"
+#include "osal_pool.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static uint32_t s_class0Blocks[(OSAL_POOL_CLASS0_SIZE * OSAL_POOL_CLASS0_COUNT) / 4U];
+static uint32_t s_class1Blocks[(OSAL_POOL_CLASS1_SIZE * OSAL_POOL_CLASS1_COUNT) / 4U];
+static uint32_t s_class2Blocks[(OSAL_POOL_CLASS2_SIZE * OSAL_POOL_CLASS2_COUNT) / 4U];
+static uint32_t s_class3Blocks[(OSAL_POOL_CLASS3_SIZE * OSAL_POOL_CLASS3_COUNT) / 4U];
+
+static OSAL_POOL_CLASS s_middlewareClasses[OSAL_POOL_CLASSES];
+static OSAL_POOL s_middlewarePool;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: OSAL Routines
+// *****************************************************************************
+// *****************************************************************************
+void OSAL_POOL_Create(OSAL_POOL *pPool, OSAL_POOL_CLASS *pClasses, uint8_t numClasses, bool heapFallback)
+{
+    pPool->pClasses = pClasses;
+    pPool->numClasses = numClasses;
+    pPool->heapFallback = heapFallback;
+    pPool->heapFallbacks = 0;
+}
+
+void OSAL_POOL_ClassSetup(OSAL_POOL *pPool, uint8_t poolClass, uint32_t *pStorage, uint16_t blockSize, uint16_t blocks)
+{
+    OSAL_POOL_CLASS *pClass = &pPool->pClasses[poolClass];
+    uint8_t *pBlock;
+    uint16_t i;
+
+    pClass->pStart = (uint8_t *)pStorage;
+    pClass->pEnd = pClass->pStart + ((uint32_t)blockSize * blocks);
+    pClass->pFree = NULL;
+    pClass->stats.blockSize = blockSize;
+    pClass->stats.blocks = blocks;
+    pClass->stats.inUse = 0;
+    pClass->stats.highWater = 0;
+    pClass->stats.allocs = 0;
+    pClass->stats.spills = 0;
+    pClass->stats.fails = 0;
+    for (i = 0; i < blocks; i++)
+    {
+        pBlock = pClass->pStart + ((uint32_t)blockSize * i);
+        *(void **)pBlock = pClass->pFree;
+        pClass->pFree = pBlock;
+    }
+}
+
+void* OSAL_POOL_Get(OSAL_POOL *pPool, size_t size)
+{
+    OSAL_CRITSECT_DATA_TYPE critStatus;
+    OSAL_POOL_CLASS *pFit = NULL;
+    OSAL_POOL_CLASS *pClass = NULL;
+    void *pBlock = NULL;
+    uint8_t i;
+
+    critStatus = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+    for (i = 0; i < pPool->numClasses; i++)
+    {
+        pClass = &pPool->pClasses[i];
+        if (size > pClass->stats.blockSize)
+        {
+            continue;
+        }
+        if (pFit == NULL)
+        {
+            pFit = pClass;
+        }
+        if (pClass->pFree != NULL)
+        {
+            pBlock = pClass->pFree;
+            pClass->pFree = *(void **)pBlock;
+            pClass->stats.allocs++;
+            pClass->stats.inUse++;
+            if (pClass->stats.inUse > pClass->stats.highWater)
+            {
+                pClass->stats.highWater = pClass->stats.inUse;
+            }
+            break;
+        }
+    }
+    if (pFit == NULL)
+    {
+        // larger than any block
+        pPool->pClasses[pPool->numClasses - 1U].stats.fails++;
+    }
+    else if (pBlock == NULL)
+    {
+        pFit->stats.fails++;
+    }
+    else if (pFit != pClass)
+    {
+        pFit->stats.spills++;
+    }
+    OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critStatus);
+
+    if ((pBlock == NULL) && pPool->heapFallback)
+    {
+        pBlock = OSAL_Malloc(size);
+        if (pBlock != NULL)
+        {
+            critStatus = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+            pPool->heapFallbacks++;
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critStatus);
+        }
+    }
+    return pBlock;
+}
+
+void OSAL_POOL_Put(OSAL_POOL *pPool, void* pData)
+{
+    OSAL_CRITSECT_DATA_TYPE critStatus;
+    OSAL_POOL_CLASS *pClass;
+    uint8_t i;
+
+    if (pData == NULL)
+    {
+        return;
+    }
+    for (i = 0; i < pPool->numClasses; i++)
+    {
+        pClass = &pPool->pClasses[i];
+        if (((uint8_t *)pData >= pClass->pStart) && ((uint8_t *)pData < pClass->pEnd))
+        {
+            critStatus = OSAL_CRIT_Enter(OSAL_CRIT_TYPE_LOW);
+            *(void **)pData = pClass->pFree;
+            pClass->pFree = pData;
+            pClass->stats.inUse--;
+            OSAL_CRIT_Leave(OSAL_CRIT_TYPE_LOW, critStatus);
+            return;
+        }
+    }
+    OSAL_Free(pData);
+}
+
+void OSAL_POOL_Init(void)
+{
+    OSAL_POOL_Create(&s_middlewarePool, s_middlewareClasses, OSAL_POOL_CLASSES, true);
+    OSAL_POOL_ClassSetup(&s_middlewarePool, 0, s_class0Blocks, OSAL_POOL_CLASS0_SIZE, OSAL_POOL_CLASS0_COUNT);
+    OSAL_POOL_ClassSetup(&s_middlewarePool, 1, s_class1Blocks, OSAL_POOL_CLASS1_SIZE, OSAL_POOL_CLASS1_COUNT);
+    OSAL_POOL_ClassSetup(&s_middlewarePool, 2, s_class2Blocks, OSAL_POOL_CLASS2_SIZE, OSAL_POOL_CLASS2_COUNT);
+    OSAL_POOL_ClassSetup(&s_middlewarePool, 3, s_class3Blocks, OSAL_POOL_CLASS3_SIZE, OSAL_POOL_CLASS3_COUNT);
+}
+
+void* OSAL_POOL_Malloc(size_t size)
+{
+    return OSAL_POOL_Get(&s_middlewarePool, size);
+}
+
+void OSAL_POOL_Free(void* pData)
+{
+    OSAL_POOL_Put(&s_middlewarePool, pData);
+}
+
+const OSAL_POOL* OSAL_POOL_GetMiddleware(void)
+{
+    return &s_middlewarePool;
+}
+
+/*******************************************************************************
+ End of File
+*/
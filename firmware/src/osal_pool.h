@@ -0,0 +1,216 @@
+/*******************************************************************************
+  Operating System Abstraction Layer Fixed Block Pools
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    osal_pool.h
+
+  Summary:
+    OSAL size class pool allocator interface file
+
+  Description:
+    Objects that are allocated and freed over and over come from static
+    pools of fixed size blocks instead of the FreeRTOS heap, so a long uptime
+    cannot fragment it. A pool is a set of size classes, smallest first. A
+    request is served by the smallest class that fits, or by the next larger
+    one while that class is empty. When every class that fits is empty the
+    pool either falls back to OSAL_Malloc or fails, as chosen when it is
+    created.
+
+    Allocating and freeing take constant time under an OSAL_CRIT_TYPE_LOW
+    critical section and may be called from any task, not from interrupts.
+
+    OSAL_POOL_Malloc and OSAL_POOL_Free use the pool of the BLE middleware
+    objects, which falls back to the heap, so the pair replaces OSAL_Malloc
+    and OSAL_Free one for one. The BLE stack events have their own pool, see
+    app_ble_evt_pool.h.
+*******************************************************************************/
+
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+
+#ifndef _OSAL_POOL_H
+#define _OSAL_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// DOM-IGNORE-END
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Constants
+// *****************************************************************************
+// *****************************************************************************
+/* Size classes of the middleware pool, block size in bytes and number of
+   blocks, smallest first. Block sizes must be multiples of 4. */
+#define OSAL_POOL_CLASS0_SIZE       (16U)
+#define OSAL_POOL_CLASS0_COUNT      (24U)
+#define OSAL_POOL_CLASS1_SIZE       (32U)
+#define OSAL_POOL_CLASS1_COUNT      (16U)
+#define OSAL_POOL_CLASS2_SIZE       (64U)
+#define OSAL_POOL_CLASS2_COUNT      (8U)
+#define OSAL_POOL_CLASS3_SIZE       (256U)
+#define OSAL_POOL_CLASS3_COUNT      (4U)
+
+#define OSAL_POOL_CLASSES           (4U)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Data Types
+// *****************************************************************************
+// *****************************************************************************
+/* Occupancy of one size class */
+typedef struct OSAL_POOL_STATS
+{
+    uint16_t    blockSize;          /* bytes per block */
+    uint16_t    blocks;             /* blocks in the class */
+    uint16_t    inUse;              /* blocks currently allocated */
+    uint16_t    highWater;          /* largest inUse seen */
+    uint32_t    allocs;             /* blocks handed out */
+    uint32_t    spills;             /* requests that fit but went to a larger class because this one was empty */
+    uint32_t    fails;              /* requests that found this and all larger classes empty, or were too large for any class */
+} OSAL_POOL_STATS;
+
+/* One size class, set up by OSAL_POOL_ClassSetup */
+typedef struct OSAL_POOL_CLASS
+{
+    uint8_t         *pStart;
+    uint8_t         *pEnd;
+    void            *pFree;
+    OSAL_POOL_STATS stats;
+} OSAL_POOL_CLASS;
+
+/* A set of size classes, set up by OSAL_POOL_Create */
+typedef struct OSAL_POOL
+{
+    OSAL_POOL_CLASS *pClasses;
+    uint8_t         numClasses;
+    bool            heapFallback;   /* requests no class could serve go to OSAL_Malloc */
+    uint32_t        heapFallbacks;  /* requests served by the heap */
+} OSAL_POOL;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Interface Routines
+// *****************************************************************************
+// *****************************************************************************
+/* Function:
+    void OSAL_POOL_Create(OSAL_POOL *pPool, OSAL_POOL_CLASS *pClasses, uint8_t numClasses, bool heapFallback)
+
+  Summary:
+    Sets up a pool of numClasses size classes, each is then filled with
+    OSAL_POOL_ClassSetup.
+
+  Remarks:
+    Must run before the first allocation, before the scheduler starts.
+*/
+void OSAL_POOL_Create(OSAL_POOL *pPool, OSAL_POOL_CLASS *pClasses, uint8_t numClasses, bool heapFallback);
+
+/* Function:
+    void OSAL_POOL_ClassSetup(OSAL_POOL *pPool, uint8_t poolClass, uint32_t *pStorage, uint16_t blockSize, uint16_t blocks)
+
+  Summary:
+    Links the blocks of pStorage, blocks times blockSize bytes, into the free
+    list of a class. Classes are ordered by size, smallest first, and
+    blockSize must be a multiple of 4.
+*/
+void OSAL_POOL_ClassSetup(OSAL_POOL *pPool, uint8_t poolClass, uint32_t *pStorage, uint16_t blockSize, uint16_t blocks);
+
+/* Function:
+    void* OSAL_POOL_Get(OSAL_POOL *pPool, size_t size)
+
+  Summary:
+    Allocates a block of at least size bytes from a pool.
+
+  Returns:
+    Pointer to the block, NULL when no class could serve the request and the
+    pool has no heap fallback or the heap is out too. The block is not
+    cleared.
+*/
+void* OSAL_POOL_Get(OSAL_POOL *pPool, size_t size);
+
+/* Function:
+    void OSAL_POOL_Put(OSAL_POOL *pPool, void* pData)
+
+  Summary:
+    Returns a block from OSAL_POOL_Get to its class, or to the heap if it
+    came from the fallback. NULL is ignored.
+*/
+void OSAL_POOL_Put(OSAL_POOL *pPool, void* pData);
+
+/* Function:
+    void OSAL_POOL_Init(void)
+
+  Summary:
+    Sets up the pool of the middleware objects.
+*/
+void OSAL_POOL_Init(void);
+
+/* Function:
+    void* OSAL_POOL_Malloc(size_t size)
+
+  Summary:
+    OSAL_POOL_Get from the middleware pool.
+*/
+void* OSAL_POOL_Malloc(size_t size);
+
+/* Function:
+    void OSAL_POOL_Free(void* pData)
+
+  Summary:
+    OSAL_POOL_Put to the middleware pool.
+*/
+void OSAL_POOL_Free(void* pData);
+
+/* Function:
+    const OSAL_POOL* OSAL_POOL_GetMiddleware(void)
+
+  Summary:
+    The middleware pool, for its statistics.
+*/
+const OSAL_POOL* OSAL_POOL_GetMiddleware(void);
+
+// DOM-IGNORE-BEGIN
+#ifdef __cplusplus
+}
+#endif
+// DOM-IGNORE-END
+
+#endif // _OSAL_POOL_H
+
+/*******************************************************************************
+ End of File
+*/
@@ -46,11 +46,15 @@
 // *****************************************************************************
 #include <string.h>
 #include "osal/osal_freertos.h"
+#include "osal_pool.h"
 #include "mba_error_defs.h"
 #include "ble_gap.h"
 #include "ble_util/byte_stream.h"
 #include "svc_client.h"
 #include "ble_gcm/ble_dd.h"
+#include "ble_dm/ble_dm.h"
+#include "pds.h"
+#include "pds_config.h"
 #include "system/console/sys_console.h"
 #include "stdio.h"
 #include "motor_control.h"
@@ -69,6 +73,14 @@
 
 #define BLE_GDMC_MAX_CONN_NBR                   BLE_GAP_MAX_LINK_NBR    // Maximum number of concurrent connections supported.
 
+#define BLE_GDMC_UUID_DATABASE_HASH             (0x2B2AU)     // UUID of the GATT Database Hash characteristic.
+#define BLE_GDMC_DATABASE_HASH_LEN              (16U)         // Length of the Database Hash value.
+
+#define BLE_GDMC_HASH_NONE                      (0x00U)       // Database Hash not read on this connection.
+#define BLE_GDMC_HASH_PENDING                   (0x01U)       // Read of the Database Hash is outstanding.
+#define BLE_GDMC_HASH_READ                      (0x02U)       // Database Hash has been read into the connection entry.
+#define BLE_GDMC_HASH_UNSUPPORTED               (0x03U)       // Peer does not expose a Database Hash, handles are not cached.
+
 typedef enum BLE_GDMC_CharAlertNotiIndex_T
 {
     GDMC_INDEX_CHARAN_NEW_ALERT,                              // Index for the New Alert characteristic.
@@ -82,6 +94,19 @@ typedef enum BLE_GDMC_State_T
     BLE_GDMC_STATE_IDLE = 0x00U,                              // State indicating the service is idle.
     BLE_GDMC_STATE_CONNECTED                                  // State indicating the service is connected.
 } BLE_GDMC_State_T;
+
+/* PDS item IDs of the cached handles, one per paired device ID of BLE_DM. */
+typedef enum BLE_GDMC_PdsItem_T
+{
+    PDS_GDMC_ITEM_ID_1 = (PDS_MODULE_APP_OFFSET),             // PDS item ID of paired device 0.
+    PDS_GDMC_ITEM_ID_2,                                       // PDS item ID of paired device 1.
+    PDS_GDMC_ITEM_ID_3,                                       // PDS item ID of paired device 2.
+    PDS_GDMC_ITEM_ID_4,                                       // PDS item ID of paired device 3.
+    PDS_GDMC_ITEM_ID_5,                                       // PDS item ID of paired device 4.
+    PDS_GDMC_ITEM_ID_6,                                       // PDS item ID of paired device 5.
+    PDS_GDMC_ITEM_ID_7,                                       // PDS item ID of paired device 6.
+    PDS_GDMC_ITEM_ID_8                                        // PDS item ID of paired device 7.
+} BLE_GDMC_PdsItem_T;
 // *****************************************************************************
 // *****************************************************************************
 // Section: Data Types
@@ -93,8 +118,20 @@ typedef struct BLE_GDMC_ConnList_T
     uint8_t           connIndex;  // Connection index associated with this connection.
     BLE_GDMC_State_T  state;      // State associated with this connection.
     uint16_t          connHandle; // Connection handle associated with this connection.
+    uint8_t           devId;      // Paired device ID of the peer, BLE_DM_PEER_DEV_ID_INVALID if not bonded.
+    bool              cached;     // Characteristic handles were restored from the cache instead of discovered.
+    uint8_t           hashState;  // Database Hash state, see BLE_GDMC_HASH_*.
+    uint8_t           dbHash[BLE_GDMC_DATABASE_HASH_LEN]; // Database Hash read from the peer.
 } BLE_GDMC_ConnList_T;
 
+/* Handles of a bonded peer as persisted in PDS. */
+typedef struct BLE_GDMC_CacheRecord_T
+{
+    BLE_GAP_Addr_T    remoteAddr;                             // Identity address of the bonded peer.
+    uint8_t           dbHash[BLE_GDMC_DATABASE_HASH_LEN];     // Database Hash the handles were discovered under.
+    BLE_DD_CharInfo_T charInfo[GDMC_INDEX_CHARAN_MAX_NUM];    // Discovered characteristic and descriptor handles.
+} BLE_GDMC_CacheRecord_T;
+
 /* The Structure service database and discovery list for BLE GDMC. */
 typedef struct BLE_GDMC_ServiceDb_T
 {
@@ -127,6 +164,28 @@ static const ATT_Uuid_T s_gdmcDiscCharControlCcc = { { UINT16_TO_BYTES(UUID_DESC
 
 // UUID for the Garage Door Motor Control Service.
 static const uint8_t s_gdmcDiscServiceUuid[] = { UINT16_TO_BYTES(BLE_GDMC_UUID_SERVICE) }; //
+
+// Cached handles of bonded peers, indexed by paired device ID. Kept per device since PDS writes are deferred.
+static BLE_GDMC_CacheRecord_T s_gdmcCache[BLE_DM_MAX_PAIRED_DEVICE_NUM];
+
+// Peer reported by BLE_GDMC_PeerConnected(), consumed by the following BLE_GAP_EVT_CONNECTED.
+static uint16_t s_gdmcPendingConnHandle;
+static uint8_t  s_gdmcPendingDevId = BLE_DM_PEER_DEV_ID_INVALID;
+static bool     s_gdmcPendingCached;
+
+/* PDS_Init() runs from SYS_Initialize() with the item count set in MCC, see the PDS step in README.md */
+#if (PDS_APP_MAX_ITEMS_AMOUNT < BLE_DM_MAX_PAIRED_DEVICE_NUM)
+#error "The GATT cache needs one application PDS item per paired device"
+#endif
+
+PDS_DECLARE_FILE(PDS_GDMC_ITEM_ID_1, (uint16_t)sizeof(BLE_GDMC_CacheRecord_T), &s_gdmcCache[0], FILE_INTEGRITY_CONTROL_MARK);
+PDS_DECLARE_FILE(PDS_GDMC_ITEM_ID_2, (uint16_t)sizeof(BLE_GDMC_CacheRecord_T), &s_gdmcCache[1], FILE_INTEGRITY_CONTROL_MARK);
+PDS_DECLARE_FILE(PDS_GDMC_ITEM_ID_3, (uint16_t)sizeof(BLE_GDMC_CacheRecord_T), &s_gdmcCache[2], FILE_INTEGRITY_CONTROL_MARK);
+PDS_DECLARE_FILE(PDS_GDMC_ITEM_ID_4, (uint16_t)sizeof(BLE_GDMC_CacheRecord_T), &s_gdmcCache[3], FILE_INTEGRITY_CONTROL_MARK);
+PDS_DECLARE_FILE(PDS_GDMC_ITEM_ID_5, (uint16_t)sizeof(BLE_GDMC_CacheRecord_T), &s_gdmcCache[4], FILE_INTEGRITY_CONTROL_MARK);
+PDS_DECLARE_FILE(PDS_GDMC_ITEM_ID_6, (uint16_t)sizeof(BLE_GDMC_CacheRecord_T), &s_gdmcCache[5], FILE_INTEGRITY_CONTROL_MARK);
+PDS_DECLARE_FILE(PDS_GDMC_ITEM_ID_7, (uint16_t)sizeof(BLE_GDMC_CacheRecord_T), &s_gdmcCache[6], FILE_INTEGRITY_CONTROL_MARK);
+PDS_DECLARE_FILE(PDS_GDMC_ITEM_ID_8, (uint16_t)sizeof(BLE_GDMC_CacheRecord_T), &s_gdmcCache[7], FILE_INTEGRITY_CONTROL_MARK);
 // *****************************************************************************
 // *****************************************************************************
 // Section: Functions
@@ -169,7 +228,7 @@ static BLE_GDMC_ConnList_T *ble_gdmc_GetFreeConnList(void)
     {
         if (sp_gdmcConnList[i] == NULL)
         {
-            sp_gdmcConnList[i] = OSAL_Malloc(sizeof(BLE_GDMC_ConnList_T));
+            sp_gdmcConnList[i] = OSAL_POOL_Malloc(sizeof(BLE_GDMC_ConnList_T));
             p_conn = sp_gdmcConnList[i];
             if (p_conn != NULL)
             {
@@ -224,6 +283,155 @@ static uint16_t ble_gdmc_ReadAlert(uint16_t connHandle, BLE_GDMC_CharAlertNotiIn
 }
 
 
+/**
+ * @brief Clears the characteristic handles of a connection index, keeping the connection handle set by BLE_DD.
+ * 
+ * @param connIndex     Index of the connection in the GDMC characteristic list.
+ */
+static void ble_gdmc_ClearCharInfo(uint8_t connIndex)
+{
+    (void)memset(sp_gdmcServiceDb->gdmcCharInfoList[connIndex], 0x0, sizeof(BLE_DD_CharInfo_T)*GDMC_INDEX_CHARAN_MAX_NUM);
+}
+
+
+/**
+ * @brief Deletes the cached handles of a paired device.
+ * 
+ * @param devId         Paired device ID.
+ */
+static void ble_gdmc_CacheDelete(uint8_t devId)
+{
+    (void)memset(&s_gdmcCache[devId], 0x0, sizeof(BLE_GDMC_CacheRecord_T));
+    (void)PDS_Delete((uint16_t)PDS_GDMC_ITEM_ID_1 + devId);
+}
+
+
+/**
+ * @brief Restores the cached handles of a paired device from PDS.
+ * 
+ * The record is only accepted if it was stored for the peer currently bonded under devId.
+ * 
+ * @param devId         Paired device ID.
+ * 
+ * @retval true         The cached handles are available in s_gdmcCache[devId].
+ * @retval false        Nothing is cached for the device.
+ */
+static bool ble_gdmc_CacheLoad(uint8_t devId)
+{
+    BLE_DM_PairedDevInfo_T pairedDev;
+
+    if (devId >= BLE_DM_MAX_PAIRED_DEVICE_NUM)
+    {
+        return false;
+    }
+    if ((PDS_IsAbleToRestore((uint16_t)PDS_GDMC_ITEM_ID_1 + devId) == false) || (PDS_Restore((uint16_t)PDS_GDMC_ITEM_ID_1 + devId) == false))
+    {
+        return false;
+    }
+    if ((BLE_DM_GetPairedDevice(devId, &pairedDev) != MBA_RES_SUCCESS) ||
+        (memcmp(&pairedDev.remoteAddr, &s_gdmcCache[devId].remoteAddr, sizeof(BLE_GAP_Addr_T)) != 0) ||
+        (s_gdmcCache[devId].charInfo[GDMC_INDEX_CHARAN_NEW_ALERT].charHandle == 0U))
+    {
+        // The device ID has been reused by another bond.
+        ble_gdmc_CacheDelete(devId);
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Stores the discovered handles of a bonded peer together with its Database Hash.
+ * 
+ * @param p_conn        Pointer to the GDMC connection list entry.
+ */
+static void ble_gdmc_CacheStore(BLE_GDMC_ConnList_T *p_conn)
+{
+    BLE_DM_PairedDevInfo_T pairedDev;
+    BLE_GDMC_CacheRecord_T *p_record;
+
+    if ((p_conn->devId >= BLE_DM_MAX_PAIRED_DEVICE_NUM) || (p_conn->cached) || (p_conn->hashState != BLE_GDMC_HASH_READ) ||
+        (sp_gdmcServiceDb->gdmcCharInfoList[p_conn->connIndex][GDMC_INDEX_CHARAN_NEW_ALERT].charHandle == 0U))
+    {
+        return;
+    }
+    if (BLE_DM_GetPairedDevice(p_conn->devId, &pairedDev) != MBA_RES_SUCCESS)
+    {
+        return;
+    }
+
+    p_record = &s_gdmcCache[p_conn->devId];
+    p_record->remoteAddr = pairedDev.remoteAddr;
+    (void)memcpy(p_record->dbHash, p_conn->dbHash, BLE_GDMC_DATABASE_HASH_LEN);
+    (void)memcpy(p_record->charInfo, sp_gdmcServiceDb->gdmcCharInfoList[p_conn->connIndex], sizeof(BLE_DD_CharInfo_T)*GDMC_INDEX_CHARAN_MAX_NUM);
+
+    (void)PDS_Store((uint16_t)PDS_GDMC_ITEM_ID_1 + p_conn->devId);
+}
+
+
+/**
+ * @brief Reads the GATT Database Hash of the peer.
+ * 
+ * @param p_conn        Pointer to the GDMC connection list entry.
+ * 
+ * @retval uint16_t     Result of the read operation.
+ */
+static uint16_t ble_gdmc_ReadDbHash(BLE_GDMC_ConnList_T *p_conn)
+{
+    GATTC_ReadByTypeParams_T readParams;
+    uint16_t result;
+
+    readParams.startHandle    = 0x0001;
+    readParams.endHandle      = 0xFFFF;
+    readParams.attrTypeLength = ATT_UUID_LENGTH_2;
+    U16_TO_BUF_LE(readParams.attrType, BLE_GDMC_UUID_DATABASE_HASH);
+
+    result = GATTC_ReadUsingUUID(p_conn->connHandle, &readParams);
+    if (result == MBA_RES_SUCCESS)
+    {
+        p_conn->hashState = BLE_GDMC_HASH_PENDING;
+    }
+    return result;
+}
+
+
+/**
+ * @brief Drops the cached handles of a connection and falls back to full service discovery.
+ * 
+ * @param p_conn        Pointer to the GDMC connection list entry.
+ */
+static void ble_gdmc_Rediscover(BLE_GDMC_ConnList_T *p_conn)
+{
+    p_conn->cached = false;
+    ble_gdmc_ClearCharInfo(p_conn->connIndex);
+    if (BLE_DD_RestartServicesDiscovery(p_conn->connHandle) != MBA_RES_SUCCESS)
+    {
+        (void)BLE_GAP_Disconnect(p_conn->connHandle, GAP_STATUS_LOCAL_HOST_TERMINATE_CONNECTION);
+    }
+}
+
+
+/**
+ * @brief Reads the control characteristic once the handles of a connection are known.
+ * 
+ * Bonded peers get their Database Hash read first so the handles can be cached.
+ * 
+ * @param p_conn        Pointer to the GDMC connection list entry.
+ */
+static void ble_gdmc_HandlesReady(BLE_GDMC_ConnList_T *p_conn)
+{
+    if ((p_conn->devId < BLE_DM_MAX_PAIRED_DEVICE_NUM) && (p_conn->hashState == BLE_GDMC_HASH_NONE))
+    {
+        if (ble_gdmc_ReadDbHash(p_conn) == MBA_RES_SUCCESS)
+        {
+            return;
+        }
+    }
+    ble_gdmc_CacheStore(p_conn);
+    (void)ble_gdmc_ReadAlert(p_conn->connHandle, GDMC_INDEX_CHARAN_NEW_ALERT);
+}
+
+
 /**
  * @brief Writes to the Alert Data Client Characteristic Configuration Descriptor (CCCD) to enable or disable notifications.
  * 
@@ -257,7 +465,7 @@ static uint16_t ble_gdmc_WriteAlertDataCccd(uint16_t connHandle, bool enable, BL
         cccValue = NOTIFICATION;
     }
 
-    p_writeParams = OSAL_Malloc(sizeof(GATTC_WriteParams_T));
+    p_writeParams = OSAL_POOL_Malloc(sizeof(GATTC_WriteParams_T));
     if (p_writeParams == NULL)
     {
         return MBA_RES_OOM;
@@ -271,7 +479,7 @@ static uint16_t ble_gdmc_WriteAlertDataCccd(uint16_t connHandle, bool enable, BL
     p_writeParams->flags = 0;
 
     result = GATTC_Write(connHandle, p_writeParams);
-    OSAL_Free(p_writeParams);
+    OSAL_POOL_Free(p_writeParams);
     return result;
 }
 
@@ -292,7 +500,7 @@ static void ble_gdmc_ProcNotificationInd(GATT_Event_T *p_event)
     }
 }
 
-extern void sendNotificationMessage(const char* buffer, uint32_t len);
+extern void APP_SendTelemetry(motorTlmRecord_t *p_rec, motorTlmType_t type);
 
 
 /**
@@ -316,10 +524,18 @@ static void ble_gdmc_ProcReadResponse(GATT_Event_T *p_event)
         if (data == 0x01)
         {
  
-            Motor_Toggle();
-            char buffer[128];
-            snprintf(buffer, 128, "Remote Button Toggle");
-            sendNotificationMessage(buffer, strlen(buffer));
+            motorTlmRecord_t record;
+
+            // the status only reports a toggle the motor queued
+            if (Motor_Toggle())
+            {
+                Motor_GetStatus(&record);
+                APP_SendTelemetry(&record, MOTOR_TLM_EVENT_REMOTE_TOGGLE);
+            }
+            else
+            {
+                SYS_CONSOLE_MESSAGE("Remote toggle dropped, motor busy\r\n");
+            }
         }
        SYS_CONSOLE_PRINT("Closing connection handle %d\r\n",p_event->eventField.onReadResp.connHandle);
         // peripheral will close connection immediately after read is complete.
@@ -339,6 +555,53 @@ static void ble_gdmc_ProcReadResponse(GATT_Event_T *p_event)
 }
 
 
+/**
+ * @brief Processes the read using UUID response event from GATT, which carries the Database Hash.
+ *
+ * @param p_event Pointer to the GATT event structure.
+ */
+static void ble_gdmc_ProcReadUsingUuidResponse(GATT_Event_T *p_event)
+{
+    GATT_EvtReadUsingUuidResp_T *p_resp = &p_event->eventField.onReadUsingUuidResp;
+    BLE_GDMC_ConnList_T *p_conn = ble_gdmc_GetConnListByHandle(p_resp->connHandle);
+
+    if ((p_conn == NULL) || (p_conn->hashState != BLE_GDMC_HASH_PENDING))
+    {
+        return;
+    }
+
+    if ((p_resp->attrPairLength != (2U + BLE_GDMC_DATABASE_HASH_LEN)) || (p_resp->attrDataLength < p_resp->attrPairLength))
+    {
+        p_conn->hashState = BLE_GDMC_HASH_UNSUPPORTED;
+    }
+    else
+    {
+        (void)memcpy(p_conn->dbHash, &p_resp->attrData[2], BLE_GDMC_DATABASE_HASH_LEN);
+        p_conn->hashState = BLE_GDMC_HASH_READ;
+    }
+
+    if (p_conn->cached)
+    {
+        if ((p_conn->hashState == BLE_GDMC_HASH_READ) &&
+            (memcmp(p_conn->dbHash, s_gdmcCache[p_conn->devId].dbHash, BLE_GDMC_DATABASE_HASH_LEN) == 0))
+        {
+            (void)ble_gdmc_ReadAlert(p_conn->connHandle, GDMC_INDEX_CHARAN_NEW_ALERT);
+            return;
+        }
+        // The peer database changed since the handles were cached, the new hash is stored after discovery.
+        if (p_conn->hashState == BLE_GDMC_HASH_UNSUPPORTED)
+        {
+            ble_gdmc_CacheDelete(p_conn->devId);
+        }
+        ble_gdmc_Rediscover(p_conn);
+    }
+    else
+    {
+        ble_gdmc_HandlesReady(p_conn);
+    }
+}
+
+
 /**
  * @brief Processes the write response event from GATT.
  *
@@ -382,6 +645,31 @@ static void ble_gdmc_ProcErrorResponse(GATT_Event_T *p_event)
         return;
     }
 
+    if ((p_conn->hashState == BLE_GDMC_HASH_PENDING) && (p_event->eventField.onError.reqOpcode == ATT_READ_BY_TYPE_REQ))
+    {
+        // No Database Hash on the peer, cached handles cannot be validated.
+        p_conn->hashState = BLE_GDMC_HASH_UNSUPPORTED;
+        if (p_conn->cached)
+        {
+            ble_gdmc_CacheDelete(p_conn->devId);
+            ble_gdmc_Rediscover(p_conn);
+        }
+        else
+        {
+            ble_gdmc_HandlesReady(p_conn);
+        }
+        return;
+    }
+
+    if ((p_conn->cached) && (p_event->eventField.onError.reqOpcode == ATT_READ_REQ) && (p_event->eventField.onError.errCode == ATT_ERR_INVALID_HANDLE) &&
+        (charHandle == sp_gdmcServiceDb->gdmcCharList[p_conn->connIndex].p_charInfo[GDMC_INDEX_CHARAN_NEW_ALERT].charHandle))
+    {
+        // Cached control handle rejected by the peer.
+        ble_gdmc_CacheDelete(p_conn->devId);
+        ble_gdmc_Rediscover(p_conn);
+        return;
+    }
+
     if (charHandle == sp_gdmcServiceDb->gdmcCharList[p_conn->connIndex].p_charInfo[GDMC_INDEX_CHARAN_NEW_ALERT_CCC].charHandle)
     {
         //evt.eventId = BLE_GDMC_EVT_WRITE_NEW_ALERT_NTFY_RSP_IND;
@@ -407,7 +695,7 @@ static void ble_gdmc_FreeConnList(BLE_GDMC_ConnList_T *p_conn)
     {
         if (sp_gdmcConnList[i] == p_conn)
         {
-            OSAL_Free(sp_gdmcConnList[i]);
+            OSAL_POOL_Free(sp_gdmcConnList[i]);
             sp_gdmcConnList[i] = NULL;
             break;
         }
@@ -436,6 +724,12 @@ static void ble_gdmc_GattEventProcess(GATT_Event_T *p_event)
         }
         break;
 
+        case GATTC_EVT_READ_USING_UUID_RESP:
+        {
+            ble_gdmc_ProcReadUsingUuidResponse(p_event);
+        }
+        break;
+
         case GATTC_EVT_WRITE_RESP:
         {
             ble_gdmc_ProcWriteResponse(p_event);
@@ -479,7 +773,25 @@ static void ble_gdmc_GapEventProcess(BLE_GAP_Event_T *p_event)
                 {
                     //SYS_CONSOLE_PRINT("Connected for connHandle %d\r\n", p_event->eventField.evtConnect.connHandle);
                     p_conn->connHandle = p_event->eventField.evtConnect.connHandle;
+                    p_conn->devId = BLE_DM_PEER_DEV_ID_INVALID;
+                    ble_gdmc_ClearCharInfo(p_conn->connIndex);
+
+                    if ((s_gdmcPendingDevId != BLE_DM_PEER_DEV_ID_INVALID) && (s_gdmcPendingConnHandle == p_conn->connHandle))
+                    {
+                        p_conn->devId = s_gdmcPendingDevId;
+                        if (s_gdmcPendingCached)
+                        {
+                            // BLE_DD skipped discovery, read straight away with the cached handles once the hash matches.
+                            (void)memcpy(sp_gdmcServiceDb->gdmcCharInfoList[p_conn->connIndex], s_gdmcCache[p_conn->devId].charInfo, sizeof(BLE_DD_CharInfo_T)*GDMC_INDEX_CHARAN_MAX_NUM);
+                            p_conn->cached = true;
+                            if (ble_gdmc_ReadDbHash(p_conn) != MBA_RES_SUCCESS)
+                            {
+                                ble_gdmc_Rediscover(p_conn);
+                            }
+                        }
+                    }
                 }
+                s_gdmcPendingDevId = BLE_DM_PEER_DEV_ID_INVALID;
             }
         }
         break;
@@ -649,6 +961,48 @@ uint16_t BLE_GDMC_GetDescList(uint16_t connHandle, BLE_GDMC_DescList_T *p_descLi
 }
 
 
+/**
+ * @brief Reports the paired device ID of a new connection.
+ *
+ * @param[in] connHandle            The connection handle to identify the BLE connection.
+ * @param[in] peerDevId             Paired device ID from the BLE_DM_EVT_CONNECTED event.
+ *
+ * @retval true                     Handles are cached for the peer, connection time discovery can be skipped.
+ * @retval false                    The peer has to be discovered.
+ */
+bool BLE_GDMC_PeerConnected(uint16_t connHandle, uint8_t peerDevId)
+{
+    if ((sp_gdmcServiceDb == NULL) || (peerDevId >= BLE_DM_MAX_PAIRED_DEVICE_NUM))
+    {
+        s_gdmcPendingDevId = BLE_DM_PEER_DEV_ID_INVALID;
+        return false;
+    }
+    s_gdmcPendingConnHandle = connHandle;
+    s_gdmcPendingDevId      = peerDevId;
+    s_gdmcPendingCached     = ble_gdmc_CacheLoad(peerDevId);
+    return s_gdmcPendingCached;
+}
+
+
+/**
+ * @brief Reports that the peer of a connection has been bonded.
+ *
+ * @param[in] connHandle            The connection handle to identify the BLE connection.
+ * @param[in] peerDevId             Paired device ID from the BLE_DM_EVT_PAIRED_DEVICE_UPDATED event.
+ */
+void BLE_GDMC_PeerBonded(uint16_t connHandle, uint8_t peerDevId)
+{
+    BLE_GDMC_ConnList_T *p_conn = ble_gdmc_GetConnListByHandle(connHandle);
+
+    if ((p_conn == NULL) || (peerDevId >= BLE_DM_MAX_PAIRED_DEVICE_NUM))
+    {
+        return;
+    }
+    p_conn->devId = peerDevId;
+    ble_gdmc_CacheStore(p_conn);
+}
+
+
 /**
  * @brief Handles BLE Database Discovery (BLE_DD) events.
  *
@@ -662,6 +1016,10 @@ void BLE_GDMC_BleDdEventHandler(BLE_DD_Event_T *p_event)
         case BLE_DD_EVT_DISC_COMPLETE:
         {
             BLE_GDMC_ConnList_T *p_conn = ble_gdmc_GetConnListByHandle(p_event->eventField.evtDiscResult.connHandle);
+            if (p_conn == NULL)
+            {
+                return;
+            }
             if (sp_gdmcServiceDb->gdmcCharList[p_conn->connIndex].p_charInfo[GDMC_INDEX_CHARAN_NEW_ALERT].charHandle != 0U)
             {
                 //SYS_CONSOLE_PRINT("Discovery Complete handle %d\r\n",p_event->eventField.evtDiscResult.connHandle);
@@ -672,16 +1030,12 @@ void BLE_GDMC_BleDdEventHandler(BLE_DD_Event_T *p_event)
                     //SYS_CONSOLE_PRINT("P: 0x%x\r\n",sp_gdmcServiceDb->gdmcCharList[p_conn->connIndex].p_charInfo[i].property);
                     //SYS_CONSOLE_PRINT("A: 0x%x\r\n",sp_gdmcServiceDb->gdmcCharList[p_conn->connIndex].p_charInfo[i].attrHandle);
                 }
-                if(p_conn == NULL)
-                {
-                    return;
-                } 
                 if (sp_gdmcServiceDb->gdmcCharList[p_conn->connIndex].p_charInfo[GDMC_INDEX_CHARAN_NEW_ALERT].charHandle != 0U)
                 {
                     //SYS_CONSOLE_MESSAGE("Discovery complete \r\n");
                 }
                 
-                ble_gdmc_ReadAlert(p_event->eventField.evtDiscResult.connHandle, GDMC_INDEX_CHARAN_NEW_ALERT);
+                ble_gdmc_HandlesReady(p_conn);
             }
         }
         break;
@@ -225,6 +225,34 @@ uint16_t BLE_GDMC_GetCharList(uint16_t connHandle, uint16_t charUuid, BLE_GDMC_C
 uint16_t BLE_GDMC_GetDescList(uint16_t connHandle, BLE_GDMC_DescList_T *p_descList);
 
 
+/**
+ * @brief Reports the paired device ID of a new connection.
+ *
+ * Bonded peers with cached handles are validated through their GATT Database Hash and
+ * read without a service discovery. Call this from the BLE_DM_EVT_CONNECTED event, before
+ * BLE_DD processes the connection, and set disableConnectedDisc of the BLE_DD configuration
+ * when true is returned.
+ *
+ * @param[in] connHandle            The connection handle to identify the BLE connection.
+ * @param[in] peerDevId             Paired device ID from the BLE_DM_EVT_CONNECTED event.
+ *
+ * @retval true                     Handles are cached for the peer, connection time discovery can be skipped.
+ * @retval false                    The peer has to be discovered.
+ */
+bool BLE_GDMC_PeerConnected(uint16_t connHandle, uint8_t peerDevId);
+
+
+/**
+ * @brief Reports that the peer of a connection has been bonded.
+ *
+ * @note Call this from the BLE_DM_EVT_PAIRED_DEVICE_UPDATED event.
+ *
+ * @param[in] connHandle            The connection handle to identify the BLE connection.
+ * @param[in] peerDevId             Paired device ID from the BLE_DM_EVT_PAIRED_DEVICE_UPDATED event.
+ */
+void BLE_GDMC_PeerBonded(uint16_t connHandle, uint8_t peerDevId);
+
+
 /**
  * @brief Handles BLE_Stack events.
  * 
@@ -0,0 +1,222 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  AD Filter Host Test Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    test_ad_filter.c
+
+  Summary:
+    Host test, fuzz harness and benchmark of app_ble_ad_filter.c.
+
+  Description:
+    Runs the known reports first, then feeds random and mutated reports to
+    the parser under the sanitizers. With "bench" as argument it times the
+    filter over a mix of crowded-environment reports instead.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "app_ble_ad_filter.h"
+#include "test_util.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static const uint16_t s_remoteUuid16[] = { 0xCD01U };
+
+/* Same filter as the door remote scan in app_ble_handler.c */
+static const APP_BLE_AdFilter_T s_remoteFilter =
+{
+    .require = APP_BLE_AD_MATCH_UUID16 | APP_BLE_AD_MATCH_NAME,
+    APP_BLE_AD_FILTER_UUID16(s_remoteUuid16),
+    APP_BLE_AD_FILTER_NAME("door_remote"),
+};
+
+static const APP_BLE_AdFilter_T s_allFilter =
+{
+    .require = APP_BLE_AD_MATCH_UUID16 | APP_BLE_AD_MATCH_NAME | APP_BLE_AD_MATCH_COMPANY,
+    APP_BLE_AD_FILTER_UUID16(s_remoteUuid16),
+    APP_BLE_AD_FILTER_NAME("door_remote"),
+    .companyId = 0x00CDU,
+};
+
+static const uint8_t s_remoteReport[] =
+{
+    2, APP_BLE_AD_TYPE_FLAGS, 0x06,
+    3, APP_BLE_AD_TYPE_UUID16_COMPLETE, 0x01, 0xCD,
+    12, APP_BLE_AD_TYPE_COMPLETE_NAME, 'd', 'o', 'o', 'r', '_', 'r', 'e', 'm', 'o', 't', 'e',
+    3, APP_BLE_AD_TYPE_MANUFACTURER, 0xCD, 0x00,
+};
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+static void test_KnownReports(void)
+{
+    static const uint8_t uuidList[] = { 7, APP_BLE_AD_TYPE_UUID16_INCOMPLETE, 0x0F, 0x18, 0x01, 0xCD, 0x0A, 0x18,
+                                        12, APP_BLE_AD_TYPE_SHORT_NAME, 'd', 'o', 'o', 'r', '_', 'r', 'e', 'm', 'o', 't', 'e' };
+    static const uint8_t shortName[] = { 3, APP_BLE_AD_TYPE_UUID16_COMPLETE, 0x01, 0xCD,
+                                         5, APP_BLE_AD_TYPE_COMPLETE_NAME, 'd', 'o', 'o', 'r' };
+    static const uint8_t oddUuid[] = { 2, APP_BLE_AD_TYPE_UUID16_COMPLETE, 0x01,
+                                       12, APP_BLE_AD_TYPE_COMPLETE_NAME, 'd', 'o', 'o', 'r', '_', 'r', 'e', 'm', 'o', 't', 'e' };
+    static const uint8_t terminated[] = { 3, APP_BLE_AD_TYPE_UUID16_COMPLETE, 0x01, 0xCD, 0,
+                                          12, APP_BLE_AD_TYPE_COMPLETE_NAME, 'd', 'o', 'o', 'r', '_', 'r', 'e', 'm', 'o', 't', 'e' };
+    static const APP_BLE_AdFilter_T none = { 0 };
+
+    TEST_CHECK(APP_BLE_AdFilter_IsMatch(&s_remoteFilter, s_remoteReport, sizeof(s_remoteReport)));
+    TEST_CHECK(APP_BLE_AdFilter_Match(&s_allFilter, s_remoteReport, sizeof(s_remoteReport)) == s_allFilter.require);
+    TEST_CHECK(APP_BLE_AdFilter_IsMatch(&s_remoteFilter, uuidList, sizeof(uuidList)));
+    TEST_CHECK(!APP_BLE_AdFilter_IsMatch(&s_remoteFilter, shortName, sizeof(shortName)));
+    TEST_CHECK(!APP_BLE_AdFilter_IsMatch(&s_remoteFilter, oddUuid, sizeof(oddUuid)));
+    TEST_CHECK(APP_BLE_AdFilter_Match(&s_remoteFilter, terminated, sizeof(terminated)) == APP_BLE_AD_MATCH_UUID16);
+    TEST_CHECK(!APP_BLE_AdFilter_IsMatch(&none, s_remoteReport, sizeof(s_remoteReport)));
+    TEST_CHECK(!APP_BLE_AdFilter_IsMatch(&s_remoteFilter, s_remoteReport, 0U));
+}
+
+/* Every cut of a valid report, the last structure must stop matching once it is cut off */
+static void test_TruncatedReports(void)
+{
+    uint16_t len;
+
+    for (len = 0U; len < sizeof(s_remoteReport); len++)
+    {
+        uint8_t *p_copy = malloc(len + 1U);
+        uint8_t matched;
+
+        memcpy(p_copy, s_remoteReport, len);
+        matched = APP_BLE_AdFilter_Match(&s_allFilter, p_copy, len);
+        TEST_CHECK((matched & APP_BLE_AD_MATCH_COMPANY) == 0U);
+        TEST_CHECK(((matched & APP_BLE_AD_MATCH_NAME) != 0U) == (len >= 20U));
+        free(p_copy);
+    }
+}
+
+/* Exact size heap copies so the sanitizers catch any read past the report */
+static void test_Fuzz(unsigned long iterations)
+{
+    unsigned long n;
+    unsigned long hits = 0;
+    uint8_t report[64];
+
+    srand(1);
+    for (n = 0; n < iterations; n++)
+    {
+        uint16_t len = (uint16_t)(rand() % (int)sizeof(report));
+        uint8_t *p_copy;
+        uint16_t i;
+
+        if ((n & 1UL) != 0UL)
+        {
+            // mostly small lengths and known types to get past the first structure
+            for (i = 0U; i < len; i++)
+            {
+                report[i] = ((rand() & 1) != 0) ? (uint8_t)(rand() % 13) : (uint8_t)rand();
+            }
+        }
+        else
+        {
+            // a valid report with a few bytes flipped
+            len = (uint16_t)(len % (sizeof(s_remoteReport) + 1U));
+            memcpy(report, s_remoteReport, len);
+            for (i = 0U; (len != 0U) && (i < 3U); i++)
+            {
+                report[rand() % len] = (uint8_t)rand();
+            }
+        }
+        p_copy = malloc((len != 0U) ? len : 1U);
+        memcpy(p_copy, report, len);
+        if (APP_BLE_AdFilter_Match(&s_allFilter, p_copy, len) != 0U)
+        {
+            hits++;
+        }
+        (void)APP_BLE_AdFilter_IsMatch(&s_remoteFilter, p_copy, len);
+        free(p_copy);
+    }
+    printf("fuzz: %lu reports, %lu partial matches\n", iterations, hits);
+}
+
+static void test_Bench(void)
+{
+    static const uint8_t phone[] = { 2, APP_BLE_AD_TYPE_FLAGS, 0x1A, 27, APP_BLE_AD_TYPE_MANUFACTURER, 0x4C, 0x00,
+                                     0x10, 0x05, 0x01, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    static const uint8_t beacon[] = { 2, APP_BLE_AD_TYPE_FLAGS, 0x06, 3, APP_BLE_AD_TYPE_UUID16_COMPLETE, 0xAA, 0xFE,
+                                      17, 0x16, 0xAA, 0xFE, 0x10, 0x00, 0x02, 'e', 'x', 'a', 'm', 'p', 'l', 'e',
+                                      '.', 'c', 'o', 'm', 0x00 };
+    static const uint8_t sensor[] = { 2, APP_BLE_AD_TYPE_FLAGS, 0x06, 5, APP_BLE_AD_TYPE_UUID16_COMPLETE, 0x0F, 0x18,
+                                      0x1A, 0x18, 9, APP_BLE_AD_TYPE_COMPLETE_NAME, 'T', 'H', 'e', 'r', 'm', 'o', '4', '2' };
+    static const struct { const uint8_t *p_data; uint16_t len; } reports[] =
+    {
+        { phone, sizeof(phone) }, { beacon, sizeof(beacon) }, { sensor, sizeof(sensor) },
+        { s_remoteReport, sizeof(s_remoteReport) },
+    };
+    const unsigned long iterations = 20000000UL;
+    volatile unsigned long hits = 0;
+    struct timespec start, end;
+    unsigned long n;
+    double ns;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (n = 0; n < iterations; n++)
+    {
+        hits += APP_BLE_AdFilter_IsMatch(&s_remoteFilter, reports[n & 3UL].p_data, reports[n & 3UL].len) ? 1UL : 0UL;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    ns = ((double)(end.tv_sec - start.tv_sec) * 1e9) + (double)(end.tv_nsec - start.tv_nsec);
+    printf("bench: %lu reports, %.1f ns per report, %lu matches\n", iterations, ns / (double)iterations, hits);
+}
+
+int main(int argc, char *argv[])
+{
+    if ((argc > 1) && (strcmp(argv[1], "bench") == 0))
+    {
+        test_Bench();
+        return 0;
+    }
+    test_KnownReports();
+    test_TruncatedReports();
+    test_Fuzz((argc > 1) ? strtoul(argv[1], NULL, 0) : 2000000UL);
+    return TEST_RESULT();
+}
+
+/*******************************************************************************
+ End of File
+ */
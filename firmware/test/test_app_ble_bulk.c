@@ -0,0 +1,422 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Bulk Channel Host Test Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    test_app_ble_bulk.c
+
+  Summary:
+    Host test of the L2CAP credit accounting in app_ble_bulk.c.
+
+  Description:
+    Plays the phone and the BLE stack: the L2CAP calls of the module are
+    stubbed so each can be made to fail, and the channel events are fed in
+    the order the stack raises them. Checks the K-frame and credit count of
+    every SDU, the credit and buffer stalls, the deferred credit returns
+    and channel rejections, and the stream resume on a free buffer.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app_ble_bulk.h"
+#include "test_util.h"
+
+#define TEST_CONN_HANDLE    (0x0041U)
+#define TEST_L2CAP_ID       (3U)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Stack Stubs
+// *****************************************************************************
+// *****************************************************************************
+static uint16_t s_sendResult;
+static uint16_t s_creditsResult;
+static uint16_t s_discResult;
+static unsigned s_sendCalls;
+static uint16_t s_lastSendLen;
+static unsigned s_creditsCalls;
+static uint16_t s_creditsReturned;
+static unsigned s_discCalls;
+static uint8_t s_lastDiscId;
+
+uint16_t BLE_L2CAP_CbInit(void)
+{
+    return MBA_RES_SUCCESS;
+}
+
+uint16_t BLE_L2CAP_CbRegisterSpsm(uint16_t spsm, uint16_t mtu, uint16_t mps, uint16_t initCredits, uint8_t permission)
+{
+    (void)spsm;
+    (void)mtu;
+    (void)mps;
+    (void)initCredits;
+    (void)permission;
+    return MBA_RES_SUCCESS;
+}
+
+uint16_t BLE_L2CAP_CbSendSdu(uint8_t leL2capId, uint16_t length, uint8_t *p_payload)
+{
+    (void)p_payload;
+    TEST_CHECK(leL2capId == TEST_L2CAP_ID);
+    s_sendCalls++;
+    s_lastSendLen = length;
+    return s_sendResult;
+}
+
+uint16_t BLE_L2CAP_CbAddCredits(uint8_t leL2capId, uint16_t credits)
+{
+    TEST_CHECK(leL2capId == TEST_L2CAP_ID);
+    s_creditsCalls++;
+    if (s_creditsResult == MBA_RES_SUCCESS)
+    {
+        s_creditsReturned += credits;
+    }
+    return s_creditsResult;
+}
+
+uint16_t BLE_L2CAP_CbDiscReq(uint8_t leL2capId)
+{
+    s_discCalls++;
+    s_lastDiscId = leL2capId;
+    return s_discResult;
+}
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Test Functions
+// *****************************************************************************
+// *****************************************************************************
+static void test_Reset(void)
+{
+    s_sendResult = MBA_RES_SUCCESS;
+    s_creditsResult = MBA_RES_SUCCESS;
+    s_discResult = MBA_RES_SUCCESS;
+    s_sendCalls = 0;
+    s_creditsCalls = 0;
+    s_creditsReturned = 0;
+    s_discCalls = 0;
+    TEST_CHECK(APP_BLE_Bulk_Init() == MBA_RES_SUCCESS);
+}
+
+static void test_Open(uint8_t leL2capId, uint16_t spsm, uint16_t mtu, uint16_t mps, uint16_t credits)
+{
+    BLE_L2CAP_Event_T event;
+
+    memset(&event, 0, sizeof(event));
+    event.eventId = BLE_L2CAP_EVT_CB_CONN_IND;
+    event.eventField.evtCbConnInd.leL2capId = leL2capId;
+    event.eventField.evtCbConnInd.connHandle = TEST_CONN_HANDLE;
+    event.eventField.evtCbConnInd.spsm = spsm;
+    event.eventField.evtCbConnInd.remoteMtu = mtu;
+    event.eventField.evtCbConnInd.remoteMps = mps;
+    event.eventField.evtCbConnInd.initialCredits = credits;
+    APP_BLE_Bulk_L2capEvtHandler(&event);
+}
+
+static void test_Event(BLE_L2CAP_EventId_T eventId, uint8_t leL2capId, uint16_t value)
+{
+    static BLE_L2CAP_Event_T event;
+
+    memset(&event, 0, sizeof(event));
+    event.eventId = eventId;
+    switch (eventId)
+    {
+        case BLE_L2CAP_EVT_CB_SDU_IND:
+            event.eventField.evtCbSduInd.leL2capId = leL2capId;
+            event.eventField.evtCbSduInd.frames = (uint8_t)value;
+        break;
+
+        case BLE_L2CAP_EVT_CB_ADD_CREDITS_IND:
+            event.eventField.evtCbAddCreditsInd.leL2capId = leL2capId;
+            event.eventField.evtCbAddCreditsInd.credits = value;
+        break;
+
+        default:
+            event.eventField.evtCbDiscInd.leL2capId = leL2capId;
+        break;
+    }
+    APP_BLE_Bulk_L2capEvtHandler(&event);
+}
+
+/* The first K-frame of an SDU carries the 2 byte SDU length */
+static void test_Frames(void)
+{
+    static uint8_t sdu[BLE_L2CAP_MAX_SDU_SIZE];
+    const APP_BLE_BulkChannel_T *p_channel = APP_BLE_Bulk_GetChannel();
+    uint16_t len;
+
+    test_Reset();
+    TEST_CHECK(!APP_BLE_Bulk_IsOpen());
+    TEST_CHECK(APP_BLE_Bulk_MaxSdu() == 0U);
+    TEST_CHECK(!APP_BLE_Bulk_Send(sdu, 1));
+    // an MPS below the spec minimum is raised to it
+    test_Open(TEST_L2CAP_ID, APP_BLE_BULK_SPSM, 1000, 10, 0xFFFFU);
+    TEST_CHECK(APP_BLE_Bulk_IsOpen());
+    TEST_CHECK(p_channel->remoteMps == BLE_L2CAP_MIN_MPS_SIZE);
+    TEST_CHECK(APP_BLE_Bulk_MaxSdu() == BLE_L2CAP_MAX_SDU_SIZE);
+    for (len = 1U; len <= BLE_L2CAP_MAX_SDU_SIZE; len++)
+    {
+        uint16_t before = p_channel->txCredits;
+        uint16_t frames = (uint16_t)((len + 2U + BLE_L2CAP_MIN_MPS_SIZE - 1U) / BLE_L2CAP_MIN_MPS_SIZE);
+
+        TEST_CHECK(APP_BLE_Bulk_Send(sdu, len));
+        TEST_CHECK((uint16_t)(before - p_channel->txCredits) == frames);
+    }
+    TEST_CHECK(!APP_BLE_Bulk_Send(sdu, 0));
+    TEST_CHECK(!APP_BLE_Bulk_Send(sdu, BLE_L2CAP_MAX_SDU_SIZE + 1U));
+    TEST_CHECK(p_channel->stats.sduSent == BLE_L2CAP_MAX_SDU_SIZE);
+
+    // the peer MTU bounds the SDU
+    test_Reset();
+    test_Open(TEST_L2CAP_ID, APP_BLE_BULK_SPSM, 100, 247, 10);
+    TEST_CHECK(APP_BLE_Bulk_MaxSdu() == 100U);
+    TEST_CHECK(APP_BLE_Bulk_Send(sdu, 100));
+    TEST_CHECK(!APP_BLE_Bulk_Send(sdu, 101));
+}
+
+static void test_Credits(void)
+{
+    uint8_t sdu[200];
+    const APP_BLE_BulkChannel_T *p_channel = APP_BLE_Bulk_GetChannel();
+
+    test_Reset();
+    // 200 bytes need 2 frames of 150
+    test_Open(TEST_L2CAP_ID, APP_BLE_BULK_SPSM, 512, 150, 3);
+    TEST_CHECK(APP_BLE_Bulk_Send(sdu, sizeof(sdu)));
+    TEST_CHECK(p_channel->txCredits == 1U);
+    s_sendCalls = 0;
+    TEST_CHECK(!APP_BLE_Bulk_Send(sdu, sizeof(sdu)));
+    TEST_CHECK(s_sendCalls == 0U);
+    TEST_CHECK(p_channel->stats.creditStalls == 1U);
+    // a free buffer does not help a credit stall
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE));
+    // credits of another channel are not ours
+    test_Event(BLE_L2CAP_EVT_CB_ADD_CREDITS_IND, TEST_L2CAP_ID + 1U, 5);
+    TEST_CHECK(p_channel->txCredits == 1U);
+    test_Event(BLE_L2CAP_EVT_CB_ADD_CREDITS_IND, TEST_L2CAP_ID, 1);
+    TEST_CHECK(APP_BLE_Bulk_Send(sdu, sizeof(sdu)));
+    TEST_CHECK(p_channel->txCredits == 0U);
+    // the count saturates at 65535
+    test_Event(BLE_L2CAP_EVT_CB_ADD_CREDITS_IND, TEST_L2CAP_ID, 0xFFF0U);
+    test_Event(BLE_L2CAP_EVT_CB_ADD_CREDITS_IND, TEST_L2CAP_ID, 0x0100U);
+    TEST_CHECK(p_channel->txCredits == 0xFFFFU);
+}
+
+static void test_BufferStall(void)
+{
+    uint8_t sdu[20];
+    const APP_BLE_BulkChannel_T *p_channel = APP_BLE_Bulk_GetChannel();
+
+    test_Reset();
+    test_Open(TEST_L2CAP_ID, APP_BLE_BULK_SPSM, 512, 247, 4);
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE));
+    s_sendResult = MBA_RES_NO_RESOURCE;
+    TEST_CHECK(!APP_BLE_Bulk_Send(sdu, sizeof(sdu)));
+    TEST_CHECK(p_channel->txCredits == 4U);
+    TEST_CHECK(p_channel->stats.bufferStalls == 1U);
+    // only the link of the channel resumes the sender, and only once
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE + 1U));
+    TEST_CHECK(APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE));
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE));
+    s_sendResult = MBA_RES_SUCCESS;
+    TEST_CHECK(APP_BLE_Bulk_Send(sdu, sizeof(sdu)));
+    TEST_CHECK(p_channel->txCredits == 3U);
+}
+
+static void test_CreditReturn(void)
+{
+    uint8_t sdu[20];
+    const APP_BLE_BulkChannel_T *p_channel = APP_BLE_Bulk_GetChannel();
+
+    test_Reset();
+    test_Open(TEST_L2CAP_ID, APP_BLE_BULK_SPSM, 512, 247, 4);
+    test_Event(BLE_L2CAP_EVT_CB_SDU_IND, TEST_L2CAP_ID, 2);
+    TEST_CHECK(s_creditsReturned == 2U);
+    TEST_CHECK(p_channel->stats.sduReceived == 1U);
+    // SDUs of another channel are ignored
+    test_Event(BLE_L2CAP_EVT_CB_SDU_IND, TEST_L2CAP_ID + 1U, 2);
+    TEST_CHECK(p_channel->stats.sduReceived == 1U);
+
+    // refused returns add up and go out with the next try
+    s_creditsResult = MBA_RES_NO_RESOURCE;
+    test_Event(BLE_L2CAP_EVT_CB_SDU_IND, TEST_L2CAP_ID, 3);
+    test_Event(BLE_L2CAP_EVT_CB_SDU_IND, TEST_L2CAP_ID, 1);
+    TEST_CHECK(p_channel->rxCreditsPending == 4U);
+    TEST_CHECK(p_channel->stats.creditReturnFails == 2U);
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE));
+    TEST_CHECK(p_channel->rxCreditsPending == 4U);
+    s_creditsResult = MBA_RES_SUCCESS;
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE));
+    TEST_CHECK(p_channel->rxCreditsPending == 0U);
+    TEST_CHECK(s_creditsReturned == 6U);
+
+    // a send retries them as well
+    s_creditsResult = MBA_RES_OOM;
+    test_Event(BLE_L2CAP_EVT_CB_SDU_IND, TEST_L2CAP_ID, 5);
+    s_creditsResult = MBA_RES_SUCCESS;
+    s_creditsCalls = 0;
+    TEST_CHECK(APP_BLE_Bulk_Send(sdu, sizeof(sdu)));
+    TEST_CHECK(s_creditsCalls == 1U);
+    TEST_CHECK(s_creditsReturned == 11U);
+    // nothing to return, nothing called
+    TEST_CHECK(APP_BLE_Bulk_Send(sdu, sizeof(sdu)));
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE));
+    TEST_CHECK(s_creditsCalls == 1U);
+
+    // the channel closing drops whatever was pending
+    s_creditsResult = MBA_RES_NO_RESOURCE;
+    test_Event(BLE_L2CAP_EVT_CB_SDU_IND, TEST_L2CAP_ID, 5);
+    APP_BLE_Bulk_Disconnected(TEST_CONN_HANDLE);
+    TEST_CHECK(!APP_BLE_Bulk_IsOpen());
+    TEST_CHECK(p_channel->rxCreditsPending == 0U);
+}
+
+static void test_Reject(void)
+{
+    const APP_BLE_BulkChannel_T *p_channel = APP_BLE_Bulk_GetChannel();
+
+    test_Reset();
+    // a wrong SPSM is turned down
+    test_Open(TEST_L2CAP_ID + 1U, APP_BLE_BULK_SPSM + 1U, 512, 247, 4);
+    TEST_CHECK(!APP_BLE_Bulk_IsOpen());
+    TEST_CHECK((s_discCalls == 1U) && (s_lastDiscId == TEST_L2CAP_ID + 1U));
+
+    // so is a second channel, the first one stays
+    test_Open(TEST_L2CAP_ID, APP_BLE_BULK_SPSM, 512, 247, 4);
+    s_discResult = MBA_RES_NO_RESOURCE;
+    test_Open(TEST_L2CAP_ID + 1U, APP_BLE_BULK_SPSM, 512, 247, 4);
+    TEST_CHECK(APP_BLE_Bulk_IsOpen());
+    TEST_CHECK(p_channel->leL2capId == TEST_L2CAP_ID);
+    TEST_CHECK(p_channel->stats.rejectFails == 1U);
+    // the refused rejection goes out on a free buffer, whatever the link
+    s_discCalls = 0;
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE + 1U));
+    TEST_CHECK(s_discCalls == 1U);
+    s_discResult = MBA_RES_SUCCESS;
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE + 1U));
+    TEST_CHECK((s_discCalls == 2U) && (s_lastDiscId == TEST_L2CAP_ID + 1U));
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE + 1U));
+    TEST_CHECK(s_discCalls == 2U);
+
+    // the phone closing the rejected channel first ends the retries
+    s_discResult = MBA_RES_NO_RESOURCE;
+    test_Open(TEST_L2CAP_ID + 2U, APP_BLE_BULK_SPSM, 512, 247, 4);
+    test_Event(BLE_L2CAP_EVT_CB_DISC_IND, TEST_L2CAP_ID + 2U, 0);
+    TEST_CHECK(APP_BLE_Bulk_IsOpen());
+    s_discCalls = 0;
+    TEST_CHECK(!APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE));
+    TEST_CHECK(s_discCalls == 0U);
+
+    test_Event(BLE_L2CAP_EVT_CB_DISC_IND, TEST_L2CAP_ID, 0);
+    TEST_CHECK(!APP_BLE_Bulk_IsOpen());
+}
+
+/* Random stack refusals and peer credits, the local count must match a model of the peer */
+static void test_Fuzz(unsigned long iterations)
+{
+    static uint8_t sdu[BLE_L2CAP_MAX_SDU_SIZE];
+    const APP_BLE_BulkChannel_T *p_channel = APP_BLE_Bulk_GetChannel();
+    uint32_t peerCredits = 8U;
+    uint32_t received = 0U;
+    unsigned long n;
+
+    test_Reset();
+    test_Open(TEST_L2CAP_ID, APP_BLE_BULK_SPSM, BLE_L2CAP_MAX_SDU_SIZE, 64, (uint16_t)peerCredits);
+    for (n = 0; n < iterations; n++)
+    {
+        int action = rand() % 4;
+
+        s_sendResult = ((rand() % 4) == 0) ? MBA_RES_NO_RESOURCE : MBA_RES_SUCCESS;
+        s_creditsResult = ((rand() % 4) == 0) ? MBA_RES_NO_RESOURCE : MBA_RES_SUCCESS;
+        if (action == 0)
+        {
+            uint16_t len = (uint16_t)(1 + (rand() % BLE_L2CAP_MAX_SDU_SIZE));
+            uint16_t frames = (uint16_t)((len + 2U + 63U) / 64U);
+            bool sent = APP_BLE_Bulk_Send(sdu, len);
+
+            TEST_CHECK(!sent || (frames <= peerCredits));
+            if (sent)
+            {
+                peerCredits -= frames;
+            }
+        }
+        else if (action == 1)
+        {
+            uint16_t credits = (uint16_t)(rand() % 8);
+
+            test_Event(BLE_L2CAP_EVT_CB_ADD_CREDITS_IND, TEST_L2CAP_ID, credits);
+            peerCredits += credits;
+            if (peerCredits > 0xFFFFU)
+            {
+                peerCredits = 0xFFFFU;
+            }
+        }
+        else if (action == 2)
+        {
+            uint8_t frames = (uint8_t)(1 + (rand() % 4));
+
+            test_Event(BLE_L2CAP_EVT_CB_SDU_IND, TEST_L2CAP_ID, frames);
+            received += frames;
+        }
+        else
+        {
+            (void)APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE);
+        }
+        TEST_CHECK(p_channel->txCredits == peerCredits);
+        TEST_CHECK((uint16_t)(s_creditsReturned + p_channel->rxCreditsPending) == (uint16_t)received);
+    }
+    s_creditsResult = MBA_RES_SUCCESS;
+    (void)APP_BLE_Bulk_TxBufAvailable(TEST_CONN_HANDLE);
+    TEST_CHECK(p_channel->rxCreditsPending == 0U);
+    printf("fuzz: %lu steps, %lu SDUs sent, stalls credit %lu buffer %lu, failed credit returns %lu\n", iterations,
+           (unsigned long)p_channel->stats.sduSent, (unsigned long)p_channel->stats.creditStalls,
+           (unsigned long)p_channel->stats.bufferStalls, (unsigned long)p_channel->stats.creditReturnFails);
+}
+
+int main(int argc, char *argv[])
+{
+    test_Frames();
+    test_Credits();
+    test_BufferStall();
+    test_CreditReturn();
+    test_Reject();
+    test_Fuzz((argc > 1) ? strtoul(argv[1], NULL, 0) : 200000UL);
+    return TEST_RESULT();
+}
+
+/*******************************************************************************
+ End of File
+ */
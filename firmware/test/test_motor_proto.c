@@ -0,0 +1,294 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Motor Command Protocol Host Test Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    test_motor_proto.c
+
+  Summary:
+    Host test of the TLV command parser in motor_proto.c.
+
+  Description:
+    Checks the frame rules (version, TLV bounds, command count, left over
+    bytes), the acknowledgement layout, the sequence gap accounting and the
+    value helpers against a stub command table, then fuzzes the parser
+    with random frames under the sanitizers.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "motor_proto.h"
+#include "test_util.h"
+
+#define TEST_CMD_ECHO       (0x01U)     /* 0-8 bytes, replies with the value */
+#define TEST_CMD_SET        (0x02U)     /* exactly 1 byte, 0xFF is out of range */
+#define TEST_CMD_BUSY       (0x03U)     /* no value, always busy */
+#define TEST_CMD_UNKNOWN    (0x7FU)
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Local Variables
+// *****************************************************************************
+// *****************************************************************************
+static unsigned s_calls;
+static uint8_t s_lastSet;
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+static motorProtoStatus_t test_CmdEcho(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    s_calls++;
+    memcpy(p_reply, p_value, len);
+    *p_replyLen = len;
+    return MOTOR_PROTO_OK;
+}
+
+static motorProtoStatus_t test_CmdSet(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)len; (void)p_reply; (void)p_replyLen;
+    s_calls++;
+    if (p_value[0] == 0xFFU)
+    {
+        return MOTOR_PROTO_BAD_VALUE;
+    }
+    s_lastSet = p_value[0];
+    return MOTOR_PROTO_OK;
+}
+
+static motorProtoStatus_t test_CmdBusy(const uint8_t *p_value, uint8_t len, uint8_t *p_reply, uint8_t *p_replyLen)
+{
+    (void)p_value; (void)len; (void)p_reply; (void)p_replyLen;
+    s_calls++;
+    return MOTOR_PROTO_BUSY;
+}
+
+static const motorProtoEntry_t s_table[] =
+{
+    { TEST_CMD_ECHO, 0, 8, test_CmdEcho },
+    { TEST_CMD_SET,  1, 1, test_CmdSet },
+    { TEST_CMD_BUSY, 0, 0, test_CmdBusy },
+};
+
+static uint16_t test_Run(const uint8_t *p_frame, uint16_t len, motorProtoSeq_t *p_seq, uint8_t *p_ack, uint16_t ackMax)
+{
+    // exact size copy so the sanitizers catch reads past the write
+    uint8_t *p_copy = malloc((len != 0U) ? len : 1U);
+    uint16_t ackLen;
+
+    memcpy(p_copy, p_frame, len);
+    ackLen = Motor_Proto_Process(s_table, (uint8_t)(sizeof(s_table) / sizeof(s_table[0])), p_copy, len, p_seq, p_ack, ackMax);
+    free(p_copy);
+    return ackLen;
+}
+
+static void test_FrameRules(void)
+{
+    static const uint8_t badVersion[] = { 2, 1, TEST_CMD_BUSY, 0, 0 };
+    static const uint8_t leftOver[] = { 1, 1, TEST_CMD_BUSY, 0, 0, 0xAA };
+    static const uint8_t countHigh[] = { 1, 2, TEST_CMD_BUSY, 0, 0 };
+    static const uint8_t countLow[] = { 1, 1, TEST_CMD_BUSY, 0, 0, TEST_CMD_BUSY, 1, 0 };
+    static const uint8_t pastEnd[] = { 1, 1, TEST_CMD_SET, 0, 2, 0x01 };
+    static const uint8_t empty[] = { 1, 0 };
+    uint8_t ack[64];
+
+    s_calls = 0;
+    TEST_CHECK(test_Run(badVersion, 1U, NULL, ack, sizeof(ack)) == MOTOR_PROTO_ACK_HEADER_LEN);
+    TEST_CHECK(ack[2] == MOTOR_PROTO_BAD_VERSION);
+    TEST_CHECK(test_Run(badVersion, sizeof(badVersion), NULL, ack, sizeof(ack)) == MOTOR_PROTO_ACK_HEADER_LEN);
+    TEST_CHECK(ack[2] == MOTOR_PROTO_BAD_VERSION);
+    TEST_CHECK(test_Run(leftOver, sizeof(leftOver), NULL, ack, sizeof(ack)) == MOTOR_PROTO_ACK_HEADER_LEN);
+    TEST_CHECK(ack[2] == MOTOR_PROTO_BAD_FRAME);
+    TEST_CHECK(test_Run(countHigh, sizeof(countHigh), NULL, ack, sizeof(ack)) == MOTOR_PROTO_ACK_HEADER_LEN);
+    TEST_CHECK(ack[2] == MOTOR_PROTO_BAD_FRAME);
+    TEST_CHECK(test_Run(countLow, sizeof(countLow), NULL, ack, sizeof(ack)) == MOTOR_PROTO_ACK_HEADER_LEN);
+    TEST_CHECK(ack[2] == MOTOR_PROTO_BAD_FRAME);
+    TEST_CHECK(test_Run(pastEnd, sizeof(pastEnd), NULL, ack, sizeof(ack)) == MOTOR_PROTO_ACK_HEADER_LEN);
+    TEST_CHECK(ack[2] == MOTOR_PROTO_BAD_FRAME);
+    // a rejected frame runs nothing
+    TEST_CHECK(s_calls == 0U);
+
+    TEST_CHECK(test_Run(empty, sizeof(empty), NULL, ack, sizeof(ack)) == MOTOR_PROTO_ACK_HEADER_LEN);
+    TEST_CHECK((ack[0] == MOTOR_PROTO_VERSION) && (ack[1] == MOTOR_PROTO_ACK) && (ack[2] == MOTOR_PROTO_OK) && (ack[3] == 0U));
+    TEST_CHECK(test_Run(empty, sizeof(empty), NULL, ack, MOTOR_PROTO_ACK_HEADER_LEN - 1U) == 0U);
+}
+
+static void test_Acknowledgements(void)
+{
+    static const uint8_t frame[] =
+    {
+        1, 5,
+        TEST_CMD_SET, 10, 1, 0x42,
+        TEST_CMD_ECHO, 11, 3, 0xA1, 0xA2, 0xA3,
+        TEST_CMD_UNKNOWN, 12, 1, 0x00,
+        TEST_CMD_SET, 13, 2, 0x01, 0x02,
+        TEST_CMD_SET, 14, 1, 0xFF,
+    };
+    static const uint8_t expected[] =
+    {
+        MOTOR_PROTO_VERSION, MOTOR_PROTO_ACK, MOTOR_PROTO_OK, 5,
+        TEST_CMD_SET, 10, MOTOR_PROTO_OK, 0,
+        TEST_CMD_ECHO, 11, MOTOR_PROTO_OK, 3, 0xA1, 0xA2, 0xA3,
+        TEST_CMD_UNKNOWN, 12, MOTOR_PROTO_UNKNOWN, 0,
+        TEST_CMD_SET, 13, MOTOR_PROTO_BAD_LENGTH, 0,
+        TEST_CMD_SET, 14, MOTOR_PROTO_BAD_VALUE, 0,
+    };
+    uint8_t ack[64];
+    uint16_t ackLen;
+
+    s_calls = 0;
+    ackLen = test_Run(frame, sizeof(frame), NULL, ack, sizeof(ack));
+    TEST_CHECK(ackLen == sizeof(expected));
+    TEST_CHECK(memcmp(ack, expected, sizeof(expected)) == 0);
+    // unknown ids and bad lengths never reach a handler
+    TEST_CHECK(s_calls == 3U);
+    TEST_CHECK(s_lastSet == 0x42U);
+    TEST_CHECK(Motor_Proto_AckFailed(ack, ackLen));
+    TEST_CHECK(!Motor_Proto_AckFailed(expected, 15U));
+    TEST_CHECK(Motor_Proto_AckFailed(expected, 3U));
+}
+
+static void test_AckFull(void)
+{
+    static const uint8_t frame[] =
+    {
+        1, 3,
+        TEST_CMD_ECHO, 1, 4, 1, 2, 3, 4,
+        TEST_CMD_ECHO, 2, 4, 5, 6, 7, 8,
+        TEST_CMD_BUSY, 3, 0,
+    };
+    uint8_t ack[64];
+    uint16_t ackLen;
+
+    s_calls = 0;
+    // room for one acknowledgement with its reply and part of the next
+    ackLen = test_Run(frame, sizeof(frame), NULL, ack, MOTOR_PROTO_ACK_HEADER_LEN + 8U + 6U);
+    TEST_CHECK(ackLen == (MOTOR_PROTO_ACK_HEADER_LEN + 8U));
+    TEST_CHECK(ack[2] == MOTOR_PROTO_ACK_FULL);
+    TEST_CHECK(ack[3] == 1U);
+    // the commands that did not fit still ran
+    TEST_CHECK(s_calls == 3U);
+    TEST_CHECK(Motor_Proto_AckFailed(ack, ackLen));
+}
+
+static void test_Sequence(void)
+{
+    static const uint8_t first[] = { 1, 2, TEST_CMD_BUSY, 254, 0, TEST_CMD_BUSY, 255, 0 };
+    static const uint8_t wrapped[] = { 1, 1, TEST_CMD_BUSY, 0, 0 };
+    static const uint8_t skipped[] = { 1, 1, TEST_CMD_BUSY, 3, 0 };
+    motorProtoSeq_t seq;
+    uint8_t ack[64];
+
+    memset(&seq, 0, sizeof(seq));
+    (void)test_Run(first, sizeof(first), &seq, ack, sizeof(ack));
+    TEST_CHECK(ack[2] == MOTOR_PROTO_OK);
+    (void)test_Run(wrapped, sizeof(wrapped), &seq, ack, sizeof(ack));
+    TEST_CHECK(ack[2] == MOTOR_PROTO_OK);
+    (void)test_Run(skipped, sizeof(skipped), &seq, ack, sizeof(ack));
+    TEST_CHECK(ack[2] == MOTOR_PROTO_SEQ_GAP);
+    TEST_CHECK((seq.received == 4U) && (seq.lost == 2U) && (seq.next == 4U));
+    // acknowledged writes are not tracked
+    (void)test_Run(first, sizeof(first), NULL, ack, sizeof(ack));
+    TEST_CHECK(ack[2] == MOTOR_PROTO_OK);
+}
+
+static void test_Values(void)
+{
+    static const uint8_t value[] = { 0xFE, 0xFF, 0xFF, 0x7F, 0x55 };
+
+    TEST_CHECK(Motor_Proto_GetU32(value, 0U) == 0U);
+    TEST_CHECK(Motor_Proto_GetU32(value, 1U) == 0xFEU);
+    TEST_CHECK(Motor_Proto_GetU32(value, 3U) == 0xFFFFFEU);
+    TEST_CHECK(Motor_Proto_GetU32(value, 5U) == 0x7FFFFFFEU);
+    TEST_CHECK(Motor_Proto_GetI32(value, 1U) == -2);
+    TEST_CHECK(Motor_Proto_GetI32(value, 2U) == -2);
+    TEST_CHECK(Motor_Proto_GetI32(value, 3U) == -2);
+    TEST_CHECK(Motor_Proto_GetI32(value, 4U) == 0x7FFFFFFE);
+    TEST_CHECK(Motor_Proto_GetI32(&value[3], 1U) == 0x7F);
+}
+
+static void test_Fuzz(unsigned long iterations)
+{
+    uint8_t frame[40];
+    uint8_t ack[64];
+    motorProtoSeq_t seq;
+    unsigned long n;
+    unsigned long accepted = 0;
+
+    srand(2);
+    memset(&seq, 0, sizeof(seq));
+    for (n = 0; n < iterations; n++)
+    {
+        uint16_t len = (uint16_t)(rand() % (int)sizeof(frame));
+        uint16_t ackMax = (uint16_t)(rand() % (int)sizeof(ack));
+        uint16_t ackLen;
+        uint16_t i;
+
+        for (i = 0U; i < len; i++)
+        {
+            // small values so lengths and ids often line up
+            frame[i] = ((rand() & 3) != 0) ? (uint8_t)(rand() % 5) : (uint8_t)rand();
+        }
+        if (len != 0U)
+        {
+            frame[0] = MOTOR_PROTO_VERSION;
+        }
+        ackLen = test_Run(frame, len, ((n & 1UL) != 0UL) ? &seq : NULL, ack, ackMax);
+        TEST_CHECK(ackLen <= ackMax);
+        if ((ackLen != 0U) && ((ack[2] == MOTOR_PROTO_OK) || (ack[2] == MOTOR_PROTO_SEQ_GAP)))
+        {
+            accepted++;
+        }
+    }
+    printf("fuzz: %lu frames, %lu accepted\n", iterations, accepted);
+}
+
+int main(int argc, char *argv[])
+{
+    test_FrameRules();
+    test_Acknowledgements();
+    test_AckFull();
+    test_Sequence();
+    test_Values();
+    test_Fuzz((argc > 1) ? strtoul(argv[1], NULL, 0) : 1000000UL);
+    return TEST_RESULT();
+}
+
+/*******************************************************************************
+ End of File
+ */
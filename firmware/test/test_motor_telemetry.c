@@ -0,0 +1,202 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Motor Telemetry Host Test Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    test_motor_telemetry.c
+
+  Summary:
+    Host round trip test of the telemetry record and stream packets.
+
+  Description:
+    Encodes records and packs stream samples with motor_telemetry.c, decodes
+    them again with the same source and compares every field, for each
+    combination of stream fields. Also checks the decoder rejects short or
+    foreign packets and ignores fields appended by a later version.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "motor_telemetry.h"
+#include "test_util.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+static void test_Record(void)
+{
+    static const motorTlmRecord_t records[] =
+    {
+        { MOTOR_TLM_VERSION, MOTOR_TLM_SAMPLE, 0x1234U, 0x89ABCDEFU, -123456789, 0xFFFFU, 3U, 1U, 2U, 0x1FU, INT32_MIN },
+        { MOTOR_TLM_VERSION, MOTOR_TLM_EVENT_REMOTE_TOGGLE, 0xFFFFU, 0U, INT32_MAX, 0U, 0U, 0U, 0U, 0U, 4096 },
+    };
+    uint8_t buf[MOTOR_TLM_RECORD_LEN + 4U];
+    motorTlmRecord_t decoded;
+    uint16_t len;
+    size_t i;
+
+    for (i = 0; i < (sizeof(records) / sizeof(records[0])); i++)
+    {
+        memset(buf, 0xA5, sizeof(buf));
+        len = Motor_Telemetry_Encode(&records[i], buf);
+        TEST_CHECK(len == MOTOR_TLM_RECORD_LEN);
+        // nothing written past the record
+        TEST_CHECK(buf[MOTOR_TLM_RECORD_LEN] == 0xA5U);
+        memset(&decoded, 0, sizeof(decoded));
+        TEST_CHECK(Motor_Telemetry_Decode(buf, len, &decoded));
+        TEST_CHECK(memcmp(&decoded, &records[i], sizeof(decoded)) == 0);
+        // a later version may append fields
+        TEST_CHECK(Motor_Telemetry_Decode(buf, sizeof(buf), &decoded));
+        TEST_CHECK(!Motor_Telemetry_Decode(buf, len - 1U, &decoded));
+    }
+    // little endian on the air whatever the host
+    TEST_CHECK((buf[2] == 0xFFU) && (buf[3] == 0xFFU) && (buf[18] == 0x00U) && (buf[19] == 0x10U));
+    buf[0] = MOTOR_TLM_VERSION + 1U;
+    TEST_CHECK(!Motor_Telemetry_Decode(buf, len, &decoded));
+}
+
+static void test_StreamFields(uint8_t fields)
+{
+    static motorTlmStream_t stream;
+    motorTlmSample_t samples[40];
+    motorTlmSample_t decoded[40];
+    motorTlmStreamHeader_t hdr;
+    uint8_t buf[100];
+    uint8_t count;
+    uint8_t decodedCount;
+    uint16_t len;
+    uint16_t i;
+    uint16_t fit;
+    uint8_t first;
+    uint16_t sampleLen = Motor_Telemetry_SampleLen(fields);
+
+    Motor_Telemetry_StreamInit(&stream, 1000U);
+    stream.decimation = 3U;
+    stream.fields = fields;
+    for (i = 0U; i < 40U; i++)
+    {
+        // indexes wrap inside the packet
+        samples[i].index = (uint16_t)(0xFFF0U + (i * 3U));
+        samples[i].rpmQ16 = -(int32_t)(i * 100000);
+        samples[i].reference = (int32_t)(i * 7777);
+        samples[i].dutyQ16 = (uint16_t)(i * 1500U);
+        samples[i].position = -(int32_t)i * 3;
+        samples[i].stateMode = (uint8_t)(i & 0x3FU);
+        (void)Motor_Telemetry_StreamPush(&stream, &samples[i]);
+    }
+
+    len = Motor_Telemetry_StreamPack(&stream, buf, sizeof(buf), 0x4321U, 1000U, &count);
+    fit = (uint16_t)((sizeof(buf) - MOTOR_TLM_STREAM_HEADER_LEN) / sampleLen);
+    TEST_CHECK(count == ((fit < 40U) ? fit : 40U));
+    TEST_CHECK(len == (MOTOR_TLM_STREAM_HEADER_LEN + (count * sampleLen)));
+    // samples stay queued until released
+    TEST_CHECK((stream.head - stream.tail) == 40U);
+
+    decodedCount = Motor_Telemetry_DecodeStream(buf, len, &hdr, decoded, 40U);
+    TEST_CHECK(decodedCount == count);
+    TEST_CHECK((hdr.sequence == 0x4321U) && (hdr.loopHz == 1000U) && (hdr.decimation == 3U) &&
+               (hdr.fields == fields) && (hdr.count == count) && (hdr.index == samples[0].index));
+    for (i = 0U; i < decodedCount; i++)
+    {
+        TEST_CHECK(decoded[i].index == samples[i].index);
+        TEST_CHECK(decoded[i].rpmQ16 == (((fields & MOTOR_TLM_FIELD_SPEED) != 0U) ? samples[i].rpmQ16 : 0));
+        TEST_CHECK(decoded[i].reference == (((fields & MOTOR_TLM_FIELD_REFERENCE) != 0U) ? samples[i].reference : 0));
+        TEST_CHECK(decoded[i].dutyQ16 == (((fields & MOTOR_TLM_FIELD_DUTY) != 0U) ? samples[i].dutyQ16 : 0U));
+        TEST_CHECK(decoded[i].position == (((fields & MOTOR_TLM_FIELD_POSITION) != 0U) ? samples[i].position : 0));
+        TEST_CHECK(decoded[i].stateMode == (((fields & MOTOR_TLM_FIELD_STATE) != 0U) ? samples[i].stateMode : 0U));
+    }
+    // a packet cut short is rejected as a whole
+    TEST_CHECK(Motor_Telemetry_DecodeStream(buf, len - 1U, &hdr, decoded, 40U) == 0U);
+
+    // the next packet carries on after the released samples
+    Motor_Telemetry_StreamRelease(&stream, count);
+    first = count;
+    len = Motor_Telemetry_StreamPack(&stream, buf, sizeof(buf), 0x4322U, 1000U, &count);
+    TEST_CHECK(count == (((40U - first) < fit) ? (40U - first) : fit));
+    if (count != 0U)
+    {
+        TEST_CHECK(Motor_Telemetry_DecodeStream(buf, len, &hdr, decoded, 40U) == count);
+        TEST_CHECK((hdr.sequence == 0x4322U) && (hdr.index == samples[first].index));
+    }
+}
+
+static void test_Stream(void)
+{
+    static motorTlmStream_t stream;
+    motorTlmSample_t sample;
+    uint8_t buf[64];
+    uint8_t count;
+    uint8_t fields;
+
+    for (fields = 1U; fields <= MOTOR_TLM_FIELD_ALL; fields++)
+    {
+        test_StreamFields(fields);
+    }
+
+    // a gap in the iterations starts a new packet
+    Motor_Telemetry_StreamInit(&stream, 1000U);
+    stream.decimation = 1U;
+    stream.fields = MOTOR_TLM_FIELD_DUTY;
+    memset(&sample, 0, sizeof(sample));
+    sample.index = 10U;
+    (void)Motor_Telemetry_StreamPush(&stream, &sample);
+    sample.index = 11U;
+    (void)Motor_Telemetry_StreamPush(&stream, &sample);
+    sample.index = 13U;
+    (void)Motor_Telemetry_StreamPush(&stream, &sample);
+    (void)Motor_Telemetry_StreamPack(&stream, buf, sizeof(buf), 0U, 1000U, &count);
+    TEST_CHECK(count == 2U);
+
+    // nothing to pack into a buffer without room for one sample
+    TEST_CHECK(Motor_Telemetry_StreamPack(&stream, buf, MOTOR_TLM_STREAM_HEADER_LEN + 1U, 0U, 1000U, &count) == 0U);
+    TEST_CHECK(count == 0U);
+    buf[1] = MOTOR_TLM_SAMPLE;
+    TEST_CHECK(Motor_Telemetry_DecodeStream(buf, sizeof(buf), (motorTlmStreamHeader_t[1]){ { 0 } }, &sample, 1U) == 0U);
+}
+
+int main(void)
+{
+    test_Record();
+    test_Stream();
+    return TEST_RESULT();
+}
+
+/*******************************************************************************
+ End of File
+ */
@@ -0,0 +1,167 @@
+// DOM-IGNORE-BEGIN
+/*******************************************************************************
+* Copyright (C) 2022 Microchip Technology Inc. and its subsidiaries.
+*
+* Subject to your compliance with these terms, you may use Microchip software
+* and any derivatives exclusively with Microchip products. It is your
+* responsibility to comply with third party license terms applicable to your
+* use of third party software (including open source software) that may
+* accompany Microchip software.
+*
+* THIS SOFTWARE IS SUPPLIED BY MICROCHIP "AS IS". NO WARRANTIES, WHETHER
+* EXPRESS, IMPLIED OR STATUTORY, APPLY TO THIS SOFTWARE, INCLUDING ANY IMPLIED
+* WARRANTIES OF NON-INFRINGEMENT, MERCHANTABILITY, AND FITNESS FOR A
+* PARTICULAR PURPOSE.
+*
+* IN NO EVENT WILL MICROCHIP BE LIABLE FOR ANY INDIRECT, SPECIAL, PUNITIVE,
+* INCIDENTAL OR CONSEQUENTIAL LOSS, DAMAGE, COST OR EXPENSE OF ANY KIND
+* WHATSOEVER RELATED TO THE SOFTWARE, HOWEVER CAUSED, EVEN IF MICROCHIP HAS
+* BEEN ADVISED OF THE POSSIBILITY OR THE DAMAGES ARE FORESEEABLE. TO THE
+* FULLEST EXTENT ALLOWED BY LAW, MICROCHIP'S TOTAL LIABILITY ON ALL CLAIMS IN
+* ANY WAY RELATED TO THIS SOFTWARE WILL NOT EXCEED THE AMOUNT OF FEES, IF ANY,
+* THAT YOU HAVE PAID DIRECTLY TO MICROCHIP FOR THIS SOFTWARE.
+*******************************************************************************/
+// DOM-IGNORE-END
+
+/*******************************************************************************
+  Telemetry Decoder Host Tool Source File
+
+  Company:
+    Microchip Technology Inc.
+
+  File Name:
+    tlm_decode.c
+
+  Summary:
+    Decodes CTRL characteristic 1 notifications captured on a host.
+
+  Description:
+    Reads one notification per line from stdin as hex digits, separators
+    such as spaces, '-' or ':' and a leading "0x" are skipped, and prints
+    the telemetry record or the stream samples it carries, one line each.
+    Decoding goes through motor_telemetry.c, the source the firmware uses.
+ *******************************************************************************/
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Included Files
+// *****************************************************************************
+// *****************************************************************************
+#include <ctype.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "motor_telemetry.h"
+
+// *****************************************************************************
+// *****************************************************************************
+// Section: Functions
+// *****************************************************************************
+// *****************************************************************************
+static int tlm_HexValue(int c)
+{
+    if ((c >= '0') && (c <= '9')) return c - '0';
+    c = tolower(c);
+    if ((c >= 'a') && (c <= 'f')) return c - 'a' + 10;
+    return -1;
+}
+
+static uint16_t tlm_ParseHex(const char *p_line, uint8_t *p_buf, uint16_t maxLen)
+{
+    uint16_t len = 0;
+    int high = -1;
+
+    while ((*p_line != '\0') && (len < maxLen))
+    {
+        int value;
+
+        if ((p_line[0] == '0') && ((p_line[1] == 'x') || (p_line[1] == 'X')) && (high < 0))
+        {
+            p_line += 2;
+            continue;
+        }
+        value = tlm_HexValue((unsigned char)*p_line++);
+        if (value < 0)
+        {
+            continue;
+        }
+        if (high < 0)
+        {
+            high = value;
+        }
+        else
+        {
+            p_buf[len++] = (uint8_t)((high << 4) | value);
+            high = -1;
+        }
+    }
+    return len;
+}
+
+static void tlm_PrintRecord(const uint8_t *p_buf, uint16_t len)
+{
+    motorTlmRecord_t rec;
+
+    if (!Motor_Telemetry_Decode(p_buf, len, &rec))
+    {
+        printf("invalid record, %u bytes\n", len);
+        return;
+    }
+    printf("record type %u seq %u t %lu ms speed %.3f rpm duty %.2f %% state %u dir %u mode %u flags 0x%02x pos %ld\n",
+           rec.type, rec.sequence, (unsigned long)rec.timestamp, (double)rec.rpmQ16 / 65536.0,
+           (double)rec.dutyQ16 * 100.0 / 65535.0, rec.state, rec.direction, rec.mode, rec.flags, (long)rec.position);
+}
+
+static void tlm_PrintStream(const uint8_t *p_buf, uint16_t len)
+{
+    motorTlmSample_t samples[UINT8_MAX];
+    motorTlmStreamHeader_t hdr;
+    uint8_t count = Motor_Telemetry_DecodeStream(p_buf, len, &hdr, samples, UINT8_MAX);
+    uint8_t i;
+
+    if (count == 0U)
+    {
+        printf("invalid stream packet, %u bytes\n", len);
+        return;
+    }
+    for (i = 0U; i < count; i++)
+    {
+        printf("sample seq %u index %u t %.6f s", hdr.sequence, samples[i].index,
+               (hdr.loopHz != 0U) ? (double)samples[i].index / hdr.loopHz : 0.0);
+        if ((hdr.fields & MOTOR_TLM_FIELD_SPEED) != 0U) printf(" speed %.3f rpm", (double)samples[i].rpmQ16 / 65536.0);
+        if ((hdr.fields & MOTOR_TLM_FIELD_REFERENCE) != 0U) printf(" ref %ld", (long)samples[i].reference);
+        if ((hdr.fields & MOTOR_TLM_FIELD_DUTY) != 0U) printf(" duty %.2f %%", (double)samples[i].dutyQ16 * 100.0 / 65535.0);
+        if ((hdr.fields & MOTOR_TLM_FIELD_POSITION) != 0U) printf(" pos %ld", (long)samples[i].position);
+        if ((hdr.fields & MOTOR_TLM_FIELD_STATE) != 0U) printf(" state %u mode %u", samples[i].stateMode & 0x0FU, samples[i].stateMode >> 4);
+        printf("\n");
+    }
+}
+
+int main(void)
+{
+    char line[1024];
+    uint8_t buf[512];
+    uint16_t len;
+
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        len = tlm_ParseHex(line, buf, sizeof(buf));
+        if (len < 2U)
+        {
+            continue;
+        }
+        if (buf[1] == MOTOR_TLM_STREAM)
+        {
+            tlm_PrintStream(buf, len);
+        }
+        else
+        {
+            tlm_PrintRecord(buf, len);
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ End of File
+ */